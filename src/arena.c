@@ -0,0 +1,65 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "arena.h"
+
+void Init_Arena(arena_t *arena, size_t capacity) {
+	assert(arena != NULL);
+
+	arena->capacity = Get_ArenaAllocSize(capacity);
+	// malloc already aligns to ARENA_ALIGNMENT on the platforms the game supports.
+	arena->memory = malloc(arena->capacity > 0 ? arena->capacity : ARENA_ALIGNMENT);
+	assert(arena->memory != NULL);
+	arena->used = 0;
+	arena->high_water = 0;
+	arena->peak = 0;
+}
+
+void Cleanup_Arena(arena_t *arena) {
+	assert(arena != NULL);
+
+	free(arena->memory);
+	arena->memory = NULL;
+	arena->capacity = 0;
+	arena->used = 0;
+}
+
+void* Alloc_Arena(arena_t *arena, size_t size) {
+	assert(arena != NULL);
+
+	const size_t alloc_size = Get_ArenaAllocSize(size);
+	assert(alloc_size <= arena->capacity - arena->used);
+
+	void *allocation = arena->memory + arena->used;
+	arena->used += alloc_size;
+	if (arena->used > arena->high_water) {
+		arena->high_water = arena->used;
+	}
+	if (arena->used > arena->peak) {
+		arena->peak = arena->used;
+	}
+	return allocation;
+}
+
+size_t Get_ArenaMark(const arena_t *arena) {
+	assert(arena != NULL);
+
+	return arena->used;
+}
+
+void Restore_ArenaMark(arena_t *arena, size_t mark) {
+	assert(arena != NULL);
+	assert(mark <= arena->used);
+
+	arena->used = mark;
+}
+
+void Reset_Arena(arena_t *arena) {
+	assert(arena != NULL);
+
+	arena->used = 0;
+	arena->high_water = 0;
+}
+
+size_t Get_ArenaAllocSize(size_t size) {
+	return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
@@ -0,0 +1,51 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 16				// Every allocation starts on this boundary, which suits any type in the game.
+
+typedef struct arena_t {
+	unsigned char *memory;
+	size_t capacity;
+	size_t used;
+	size_t high_water;					// Most bytes in use at once since the arena was last reset.
+	size_t peak;						// Most bytes in use at once since the arena was initialised.
+} arena_t;
+
+/*
+	Allocates an arena of 'capacity' bytes up front. No allocation from the arena touches the heap afterwards.
+*/
+void Init_Arena(arena_t *arena, size_t capacity);
+
+/*
+	Frees all memory allocated from calling 'Init_Arena'.
+*/
+void Cleanup_Arena(arena_t *arena);
+
+/*
+	Returns 'size' bytes from the arena, aligned to ARENA_ALIGNMENT. The arena must have room for them.
+*/
+void* Alloc_Arena(arena_t *arena, size_t size);
+
+/*
+	Returns the current end of the arena's allocations, so everything allocated after it can be released with 'Restore_ArenaMark'.
+*/
+size_t Get_ArenaMark(const arena_t *arena);
+
+/*
+	Releases every allocation made since 'mark' was taken.
+*/
+void Restore_ArenaMark(arena_t *arena, size_t mark);
+
+/*
+	Releases every allocation in the arena at once.
+*/
+void Reset_Arena(arena_t *arena);
+
+/*
+	Returns the number of arena bytes taken by an allocation of 'size' bytes, including alignment padding.
+*/
+size_t Get_ArenaAllocSize(size_t size);
+
+#endif // !ARENA_H_
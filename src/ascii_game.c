@@ -8,13 +8,19 @@
 #include <math.h>
 #include <curses.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "george_graphics.h"
 #include "log_messages.h"
 #include "items.h"
 #include "enemies.h"
 #include "coord.h"
 #include "tiles.h"
+#include "bitgrid.h"
+#include "map_file.h"
 #include "ascii_game.h"
+#include "prefabs.h"
+#include "field_of_view.h"
+#include "session_log.h"
 
 bool g_resize_error = false;	// Global flag which is set when a terminal resize interrupt occurs.
 bool g_process_over = false;	// Global flag which controls the main while loop of the game.
@@ -28,42 +34,181 @@ static int Get_KeyInput(game_state_t *state);
 /*
 	Gets the radius of the next room to be created.
 */
-static int Get_NextRoomRadius(void);
+static int Get_NextRoomRadius(game_state_t *state);
 
 /*
 	Resets all world tiles to default empty tiles.
 */
 static void Reset_WorldTiles(game_state_t *state);
 
+/*
+	Copies 'length' tiles into one column of the world, from 'pos' downwards, keeping the spatial hashes current.
+*/
+static void Copy_WorldTileSpan(game_state_t *state, coord_t pos, const tile_t *tiles, int length);
+
+/*
+	Brings the solid tile mask up to date with the world tile at 'pos', marking the field of view to be computed again if a visible tile changed whether it blocks sight.
+*/
+static void Update_SolidMaskTile(game_state_t *state, coord_t pos);
+
+/*
+	Remembers how each tile in the player's last field of view looks, leaving out enemies, which won't stay where they were seen.
+*/
+static void Remember_VisibleTiles(game_state_t *state);
+
+/*
+	Brings the world glyph at 'pos' up to date with the world tile's foreground.
+*/
+static void Update_WorldGlyph(game_state_t *state, coord_t pos);
+
+/*
+	Returns the size of the floor arena: enough for the largest floor the world can hold, so no floor ever outgrows it.
+*/
+static size_t Get_FloorArenaCapacity(void);
+
+/*
+	Releases every floor-scoped allocation at once, leaving only an empty enemy pool, pathfinder, scheduler, enemy plans, spatial hashes, explored tiles, world glyphs
+	and remembered glyphs (the first allocations of every floor) in the floor arena.
+*/
+static void Reset_FloorArena(game_state_t *state);
+
+/*
+	Plans the actions of the enemy plans from 'begin' to 'end' (a thread pool task over a 'game_state_t'): the steps downhill in the flow field, towards (or onto) the player.
+	Only reads the world, so any number of threads can plan a batch at once.
+*/
+static void Plan_EnemyTurns(void *context, int begin, int end);
+
+/*
+	Plans every action in the current batch, then carries them out in order: each enemy takes the first of its planned steps that is still free,
+	or attacks the player if that step is onto the player's tile.
+*/
+static void Commit_EnemyPlans(game_state_t *state);
+
 /*
 	Draws elements related to UI to the screen.
 */
-static void Draw_UI(const game_state_t *state);
+static void Draw_UI(game_state_t *state);
 
 /*
 	Defines a room of size 'radius' at position 'pos' (initialises the locations for each of the room's corners).
 */
 static void Define_Room(room_t *room, coord_t pos, int radius);
 
+/*
+	Returns the position at the center of a room.
+*/
+static coord_t Get_RoomCenter(const room_t *room);
+
 /*
 	Updates world tiles to generate a room.
 */
-static void Generate_Room(tile_t **world_tiles, const room_t *room);
+static void Generate_Room(game_state_t *state, const room_t *room);
 
 /*
 	Updates world tiles to generate a corridor of length 'corridor_size' from 'starting_room' in the specified 'direction'.
 */
-static void Generate_Corridor(tile_t **world_tiles, coord_t starting_room, int corridor_size, direction_en direction);
+static void Generate_Corridor(game_state_t *state, coord_t starting_room, int corridor_size, direction_en direction);
+
+/*
+	Creates a single dungeon floor room of size 'radius' at position 'pos' (stamped from 'prefab' unless it is NULL) and tries to set up further rooms with connecting corridors recursively.
+*/
+static void Create_RoomsRecursively(game_state_t *state, coord_t pos, int radius, const prefab_t *prefab, int max_rooms);
+
+/*
+	Returns a random prefab of size 'radius' with (at least) the doors in 'required_doors', or NULL if the room should be a plain room (by chance, or because no prefab matches).
+*/
+static const prefab_t* Get_RandomPrefab(game_state_t *state, int radius, unsigned int required_doors);
+
+/*
+	Returns true if the prefab, placed at 'room', collides with anything solid or world map boundaries. Only tiles in the prefab's footprint are checked.
+*/
+static bool Check_PrefabCollision(const tile_t **world_tiles, const prefab_t *prefab, const room_t *room);
+
+/*
+	Updates world tiles to stamp a prefab at 'room', one column copy at a time. Doors marked by a connecting corridor are opened; the rest are walled up.
+*/
+static void Generate_PrefabRoom(game_state_t *state, const prefab_t *prefab, const room_t *room);
+
+/*
+	Returns the direction opposite to 'direction'.
+*/
+static direction_en Get_OppositeDirection(direction_en direction);
+
+/*
+	Creates the rooms of a dungeon floor with the specified 'layout', then populates them.
+*/
+static void Create_DungeonFloorLayout(game_state_t *state, int num_rooms_specified, floor_layout_en layout);
+
+/*
+	Creates 'num_rooms' dungeon floor rooms inside 'area' by recursively splitting it in two (a binary space partition), connecting each pair of split halves with a corridor.
+	Returns the index of a room inside 'area' for the caller to connect its own corridor to.
+*/
+static int Create_RoomsBSP(game_state_t *state, const room_t *area, int num_rooms);
+
+/*
+	Updates world tiles to generate an L-shaped corridor between positions 'from' and 'to', carving openings through any walls in the way.
+*/
+static void Generate_CorridorBetween(game_state_t *state, coord_t from, coord_t to);
+
+/*
+	Creates a dungeon floor's cave with a cellular automaton, then marks out 'num_rooms' areas inside it to be populated like rooms.
+*/
+static void Create_CaveRooms(game_state_t *state, int num_rooms);
+
+/*
+	Creates a dungeon floor's rooms by stamping a map template, centered in the world.
+*/
+static void Create_RoomsFromTemplate(game_state_t *state, const map_template_t *map_template);
+
+/*
+	Allocates a map template's tiles for a 'width' x 'height' map, all set to ground, centered on the world by default.
+*/
+static void Allocate_MapTemplate(map_template_t *map_template, int width, int height);
+
+/*
+	Adds an enemy spawn to a map template, growing its spawn list (of size 'enemy_spawns_capacity') as needed.
+*/
+static void Add_MapTemplateEnemySpawn(map_template_t *map_template, const enemy_data_t *enemy_data, coord_t pos, int *enemy_spawns_capacity);
+
+/*
+	Decodes a mapped txt map file, sprite by sprite, into a map template.
+*/
+static void Decode_TextMapTemplate(map_template_t *map_template, const map_file_t *map);
+
+/*
+	Decodes a mapped compiled binary map file into a map template. Returns false if the data is truncated or invalid.
+*/
+static bool Decode_BinaryMapTemplate(map_template_t *map_template, const unsigned char *data, size_t size);
+
+/*
+	Reads the next byte of a compiled binary map. Marks the reader as failed (returning 0) if there are no bytes left.
+*/
+static int Read_MapU8(map_reader_t *reader);
+
+/*
+	Reads the next little-endian 16-bit value of a compiled binary map. Marks the reader as failed if there are not enough bytes left.
+*/
+static int Read_MapU16(map_reader_t *reader);
+
+/*
+	Writes a little-endian 16-bit value to a compiled binary map.
+*/
+static void Write_MapU16(FILE *fp, int value);
+
+/*
+	Writes a single entry of a compiled binary map's spawn table.
+*/
+static void Write_MapSpawn(FILE *fp, map_spawn_en kind, int slug, coord_t pos);
 
 /*
-	Creates a single dungeon floor room of size 'radius' at position 'pos' and tries to set up further rooms with connecting corridors recursively.
+	Returns the slug of a tile from the global tile data database.
 */
-static void Create_RoomsRecursively(game_state_t *state, coord_t pos, int radius, int max_rooms);
+static int Get_TileSlug(const tile_data_t *tile_data);
 
 /*
-	Creates a dungeon floor's rooms from a txt file named 'filename'. 
+	Returns true if the map template's tiles at positions 'a' and 'b' hold the same tile data and item.
 */
-static void Create_RoomsFromFile(game_state_t *state, const char *filename);
+static bool Check_MapTemplateTilesEqual(const map_template_t *map_template, coord_t a, coord_t b);
 
 /*
 	Populates a dungeon floor's rooms with entities (items, enemies, gold, npcs, specials, etc.)
@@ -90,6 +235,11 @@ static bool Check_RoomOutOfWorldBounds(const room_t *room);
 */
 static void Perform_WorldLogic(game_state_t *state, coord_t player_old_pos);
 
+/*
+	Pushes a summary of the turn just performed to the session log, if the game log has one.
+*/
+static void Record_SessionTurn(const game_state_t *state);
+
 /*
 	Performs player logic for the current game turn. Waits for the user's next input, then performs logic.
 	Returns true if the input counts towards ending the player's turn, otherwise false (e.g. opening help screen, selecting items, etc.)
@@ -104,17 +254,23 @@ void Init_GameState(game_state_t *state) {
 	const int world_screen_w = Get_WorldScreenWidth();
 	const int world_screen_h = Get_WorldScreenHeight();
 
-	state->debug_seed = time(NULL);
-	srand(state->debug_seed);
+	Seed_GameState(state, time(NULL));
 
 	state->game_turns = 0;
+	state->game_time = 0;
+	state->num_enemy_plans = 0;
+	state->enemy_planners = NULL;
 	state->num_rooms_created = 0;
 	state->current_floor = 1;
 	state->fog_of_war = true;
 	state->player_turn_over = false;
 	state->floor_complete = false;
+	state->regenerate_unreachable_floors = true;
 	state->debug_rcs = 0;
-	state->enemy_list = (enemy_node_t*)NULL;
+	state->staircase_pos = NewCoord(-1, -1);
+	state->prefab_library = NULL;
+	state->connectivity.reachable_area = 0;
+	state->connectivity.staircase_distance = -1;
 	state->rooms = (room_t*)NULL;
 	state->debug_injected_input_pos = 0;
 	memset(state->debug_injected_inputs, '\0', sizeof(state->debug_injected_inputs));
@@ -125,16 +281,43 @@ void Init_GameState(game_state_t *state) {
 	for (int i = 0; i < world_screen_w; i++) {
 		state->world_tiles[i] = malloc(sizeof(*state->world_tiles[i]) * world_screen_h);
 		assert(state->world_tiles[i] != NULL);
+
+		// The setters work out each tile's glyph from what it already holds, so it must hold something valid.
+		for (int j = 0; j < world_screen_h; j++) {
+			state->world_tiles[i][j] = (tile_t){.data = GetTileData(TileSlug_VOID), .enemy_occupier = ENEMY_NONE, .item_occupier = NULL};
+		}
 	}
 
+	Init_BitGrid(&state->walkable_mask, world_screen_w, world_screen_h);
+	Init_BitGrid(&state->reachable_mask, world_screen_w, world_screen_h);
+	Init_BitGrid(&state->frontier_mask, world_screen_w, world_screen_h);
+	Init_BitGrid(&state->scratch_mask, world_screen_w, world_screen_h);
+	Init_BitGrid(&state->solid_mask, world_screen_w, world_screen_h);
+	Init_BitGrid(&state->visible_mask, world_screen_w, world_screen_h);
+	state->fov_origin = NewCoord(-1, -1);
+	state->fov_max_vision = 0;
+	state->fov_dirty = true;
+	state->debug_fov_usec = 0.0;
+
 	// Create empty world space.
+	Init_Arena(&state->floor_arena, Get_FloorArenaCapacity());
+	Reset_FloorArena(state);
 	Reset_WorldTiles(state);
 
-	snprintf(state->game_log.line1, LOG_BUFFER_SIZE, LOGMSG_EMPTY_SPACE);
-	snprintf(state->game_log.line2, LOG_BUFFER_SIZE, LOGMSG_EMPTY_SPACE);
-	snprintf(state->game_log.line3, LOG_BUFFER_SIZE, LOGMSG_EMPTY_SPACE);
-	snprintf(state->game_log.line4, LOG_BUFFER_SIZE, LOGMSG_EMPTY_SPACE);
-	snprintf(state->game_log.line5, LOG_BUFFER_SIZE, LOGMSG_EMPTY_SPACE);
+	state->flow_field = malloc(sizeof(*state->flow_field) * world_screen_w * world_screen_h);
+	assert(state->flow_field != NULL);
+	state->flow_queue = malloc(sizeof(*state->flow_queue) * world_screen_w * world_screen_h);
+	assert(state->flow_queue != NULL);
+	memset(state->flow_field, 0xFF, sizeof(*state->flow_field) * world_screen_w * world_screen_h);
+
+	Init_GameLog(&state->game_log);
+}
+
+void Seed_GameState(game_state_t *state, unsigned int seed) {
+	assert(state != NULL);
+
+	state->debug_seed = seed;
+	state->rng_state = seed;
 }
 
 void Cleanup_GameState(game_state_t *state) {
@@ -146,60 +329,235 @@ void Cleanup_GameState(game_state_t *state) {
 		free(state->world_tiles[i]);
 	}
 	free(state->world_tiles);
+
+	Cleanup_Arena(&state->floor_arena);
+	Cleanup_BitGrid(&state->walkable_mask);
+	Cleanup_BitGrid(&state->reachable_mask);
+	Cleanup_BitGrid(&state->frontier_mask);
+	Cleanup_BitGrid(&state->scratch_mask);
+	Cleanup_BitGrid(&state->solid_mask);
+	Cleanup_BitGrid(&state->visible_mask);
+
+	free(state->flow_field);
+	free(state->flow_queue);
+
+	Cleanup_GameLog(&state->game_log);
 }
 
 void Cleanup_DungeonFloor(game_state_t *state) {
 	assert(state != NULL);
 
-	FreeEnemyList(&state->enemy_list);
-	state->enemy_list = (enemy_node_t*)NULL;
-
-	free(state->rooms);
+	Reset_FloorArena(state);
 	state->rooms = (room_t*)NULL;
 }
 
+static size_t Get_FloorArenaCapacity(void) {
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// Enemies never share a tile, so the world's area bounds the number of enemies on a floor.
+	return Get_EnemyPoolSize(world_screen_w * world_screen_h, world_screen_w, world_screen_h)
+		+ Get_PathfinderSize(world_screen_w, world_screen_h)
+		+ Get_SchedulerSize(world_screen_w * world_screen_h)
+		+ (Get_SpatialHashSize(world_screen_w, world_screen_h) * 2)
+		+ Get_BitGridSize(world_screen_w, world_screen_h)
+		+ (Get_GlyphLayerSize(world_screen_w, world_screen_h) * 2)
+		+ Get_ArenaAllocSize(sizeof(enemy_plan_t) * world_screen_w * world_screen_h)
+		+ Get_ArenaAllocSize(sizeof(bool) * world_screen_w * world_screen_h)
+		+ Get_ArenaAllocSize(sizeof(room_t) * MAX_ROOMS)
+		+ (Get_BitGridSize(world_screen_w, world_screen_h) * 3)		// Cave generation's grids.
+		+ Get_ArenaAllocSize(sizeof(bool) * world_screen_h * 2);	// Flood fill row flags.
+}
+
+static void Reset_FloorArena(game_state_t *state) {
+	assert(state != NULL);
+
+	Reset_Arena(&state->floor_arena);
+	Init_EnemyPool(&state->enemy_pool, &state->floor_arena, Get_WorldScreenWidth() * Get_WorldScreenHeight(), Get_WorldScreenWidth(), Get_WorldScreenHeight());
+	Init_Pathfinder(&state->pathfinder, &state->floor_arena, Get_WorldScreenWidth(), Get_WorldScreenHeight());
+	Init_Scheduler(&state->enemy_scheduler, &state->floor_arena, Get_WorldScreenWidth() * Get_WorldScreenHeight());
+	Init_SpatialHash(&state->enemy_hash, &state->floor_arena, Get_WorldScreenWidth(), Get_WorldScreenHeight());
+	Init_SpatialHash(&state->item_hash, &state->floor_arena, Get_WorldScreenWidth(), Get_WorldScreenHeight());
+	Init_BitGridInArena(&state->explored_mask, &state->floor_arena, Get_WorldScreenWidth(), Get_WorldScreenHeight());
+	Init_GlyphLayer(&state->world_glyphs, &state->floor_arena, Get_WorldScreenWidth(), Get_WorldScreenHeight());
+	Init_GlyphLayer(&state->remembered_glyphs, &state->floor_arena, Get_WorldScreenWidth(), Get_WorldScreenHeight());
+
+	// Each enemy acts at most once per batch, so a batch never holds more actions than the pool has enemies.
+	state->enemy_plans = Alloc_Arena(&state->floor_arena, sizeof(*state->enemy_plans) * state->enemy_pool.capacity);
+	state->enemy_planned = Alloc_Arena(&state->floor_arena, sizeof(*state->enemy_planned) * state->enemy_pool.capacity);
+	memset(state->enemy_planned, 0, sizeof(*state->enemy_planned) * state->enemy_pool.capacity);
+	state->num_enemy_plans = 0;
+}
+
+static void Copy_WorldTileSpan(game_state_t *state, coord_t pos, const tile_t *tiles, int length) {
+	assert(state != NULL);
+	assert(tiles != NULL);
+
+	// Occupiers are overwritten by the copy, so they leave the spatial hashes first, and the copied items join them after.
+	for (int i = 0; i < length; i++) {
+		Update_WorldTileItemOccupier(state, NewCoord(pos.x, pos.y + i), NULL);
+		Update_WorldTileEnemyOccupier(state, NewCoord(pos.x, pos.y + i), ENEMY_NONE);
+	}
+
+	memcpy(&state->world_tiles[pos.x][pos.y], tiles, sizeof(*tiles) * length);
+
+	for (int i = 0; i < length; i++) {
+		Update_SolidMaskTile(state, NewCoord(pos.x, pos.y + i));
+		Update_WorldGlyph(state, NewCoord(pos.x, pos.y + i));
+		if (tiles[i].item_occupier != NULL) {
+			Set_SpatialHashTile(&state->item_hash, NewCoord(pos.x, pos.y + i), true);
+		}
+		if (tiles[i].enemy_occupier != ENEMY_NONE) {
+			Set_SpatialHashTile(&state->enemy_hash, NewCoord(pos.x, pos.y + i), true);
+		}
+	}
+}
+
+static void Update_SolidMaskTile(game_state_t *state, coord_t pos) {
+	const bool solid = state->world_tiles[pos.x][pos.y].data->type == TileType_SOLID;
+	if (solid != Get_BitGridCell(&state->solid_mask, pos.x, pos.y)) {
+		Set_BitGridCell(&state->solid_mask, pos.x, pos.y, solid);
+
+		// Hidden tiles lie in the shadow of visible ones, so they can't change what is seen.
+		if (Get_BitGridCell(&state->visible_mask, pos.x, pos.y)) {
+			state->fov_dirty = true;
+		}
+	}
+}
+
+static void Remember_VisibleTiles(game_state_t *state) {
+	const int reach = (int)ceil(sqrt(state->fov_max_vision));
+	const int min_x = CLAMP(state->fov_origin.x - reach, 0, state->visible_mask.width - 1);
+	const int max_x = CLAMP(state->fov_origin.x + reach, 0, state->visible_mask.width - 1);
+	const int min_y = CLAMP(state->fov_origin.y - reach, 0, state->visible_mask.height - 1);
+	const int max_y = CLAMP(state->fov_origin.y + reach, 0, state->visible_mask.height - 1);
+
+	for (int y = min_y; y <= max_y; y++) {
+		for (int x = min_x; x <= max_x; x++) {
+			if (!Get_BitGridCell(&state->visible_mask, x, y)) {
+				continue;
+			}
+
+			// Only tiles with an enemy need their glyph worked out again, to see what lies under it.
+			tile_t seen = state->world_tiles[x][y];
+			if (seen.enemy_occupier != ENEMY_NONE) {
+				seen.enemy_occupier = ENEMY_NONE;
+				Set_Glyph(&state->remembered_glyphs, NewCoord(x, y), Get_TileForegroundSprite(&state->enemy_pool, &seen), Get_TileForegroundColour(&seen) | GEO_DIM);
+			} else {
+				const int glyph = (y * state->world_glyphs.width) + x;
+				Set_Glyph(&state->remembered_glyphs, NewCoord(x, y), state->world_glyphs.sprites[glyph], state->world_glyphs.colours[glyph] | GEO_DIM);
+			}
+		}
+	}
+}
+
+static void Update_WorldGlyph(game_state_t *state, coord_t pos) {
+	const tile_t *tile = &state->world_tiles[pos.x][pos.y];
+	Set_Glyph(&state->world_glyphs, pos, Get_TileForegroundSprite(&state->enemy_pool, tile), Get_TileForegroundColour(tile));
+}
+
 static void Reset_WorldTiles(game_state_t *state) {
 	const int world_screen_w = Get_WorldScreenWidth();
 	const int world_screen_h = Get_WorldScreenHeight();
 
 	for (int x = 0; x < world_screen_w; x++) {
 		for (int y = 0; y < world_screen_h; y++) {
+			// Enemies go first, as their pool may already have been reset under them.
 			coord_t coord = NewCoord(x, y);
-			Update_WorldTile(state->world_tiles, coord, GetTileData(TileSlug_VOID));
-			Update_WorldTileItemOccupier(state->world_tiles, coord, NULL);
-			Update_WorldTileEnemyOccupier(state->world_tiles, coord, NULL);
+			Update_WorldTileEnemyOccupier(state, coord, ENEMY_NONE);
+			Update_WorldTileItemOccupier(state, coord, NULL);
+			Update_WorldTile(state, coord, GetTileData(TileSlug_VOID));
 		}
 	}
 }
 
-void InitCreate_DungeonFloor(game_state_t *state, unsigned int num_rooms_specified, const char *filename_specified) {
+void InitCreate_DungeonFloor(game_state_t *state, unsigned int num_rooms_specified, floor_layout_en layout, const map_template_t *map_template) {
 	assert(state != NULL);
 	assert(num_rooms_specified >= MIN_ROOMS);
 	assert(num_rooms_specified <= MAX_ROOMS);
 
-	// Make sure dungeon floor values are reset from any previous floors.
-	Reset_WorldTiles(state);
 	state->fog_of_war = true;
-	state->num_rooms_created = 0;
-	state->debug_rcs = 0;
-	state->rooms = malloc(sizeof(*state->rooms) * num_rooms_specified);
-	assert(state->rooms != NULL);
+	state->fov_dirty = true;
+	Clear_BitGrid(&state->visible_mask);
+	state->rooms = Alloc_Arena(&state->floor_arena, sizeof(*state->rooms) * num_rooms_specified);
+
+	for (int attempt = 1; ; attempt++) {
+		// Make sure dungeon floor values are reset from any previous floors (or any previous attempt at this one).
+		Reset_WorldTiles(state);
+		Reset_EnemyPool(&state->enemy_pool);
+		state->num_rooms_created = 0;
+		state->debug_rcs = 0;
+		state->staircase_pos = NewCoord(-1, -1);
+
+		// Create the new dungeon floor.
+		if (map_template != NULL) {
+			Create_RoomsFromTemplate(state, map_template);
+		} else {
+			Create_DungeonFloorLayout(state, num_rooms_specified, layout);
+		}
+
+		// Custom layouts are used as is, but generated floors are retried until the player can reach the staircase.
+		state->connectivity = Validate_FloorConnectivity(state);
+		if (map_template != NULL || !state->regenerate_unreachable_floors
+			|| state->connectivity.staircase_distance != -1 || attempt >= FLOOR_GENERATION_ATTEMPTS) {
+			break;
+		}
+	}
+
+	Log_GameEvent(&state->game_log, LogEvent_PLR_NEW_FLOOR, state->current_floor);
+}
+
+static void Create_DungeonFloorLayout(game_state_t *state, int num_rooms_specified, floor_layout_en layout) {
+	assert(state != NULL);
 
-	// Create the new dungeon floor.
-	if (filename_specified != NULL) {
-		Create_RoomsFromFile(state, filename_specified);
+	if (layout == FloorLayout_CAVE) {
+		Create_CaveRooms(state, num_rooms_specified);
+		Populate_Rooms(state);
+	} else if (layout == FloorLayout_BSP) {
+		const room_t world_area = {
+			.TL_corner = NewCoord(0, TOP_PANEL_OFFSET),
+			.TR_corner = NewCoord(Get_WorldScreenWidth() - 1, TOP_PANEL_OFFSET),
+			.BL_corner = NewCoord(0, Get_WorldScreenHeight() - 1),
+			.BR_corner = NewCoord(Get_WorldScreenWidth() - 1, Get_WorldScreenHeight() - 1)
+		};
+
+		Create_RoomsBSP(state, &world_area, num_rooms_specified);
+		Populate_Rooms(state);
 	} else {
 		int starting_room_radius = 2;
 		coord_t starting_room_pos = NewCoord(Get_WorldScreenWidth() / 2, Get_WorldScreenHeight() / 2);
 		Define_Room(&state->rooms[0], starting_room_pos, starting_room_radius);
 
 		if (!Check_RoomCollision((const tile_t**)state->world_tiles, &state->rooms[0])) {
-			Create_RoomsRecursively(state, starting_room_pos, starting_room_radius, num_rooms_specified);
+			Create_RoomsRecursively(state, starting_room_pos, starting_room_radius, NULL, num_rooms_specified);
 			Populate_Rooms(state);
 		}
 	}
+}
+
+floor_connectivity_t Validate_FloorConnectivity(game_state_t *state) {
+	assert(state != NULL);
+
+	floor_connectivity_t connectivity = {.reachable_area = 0, .staircase_distance = -1};
+	if (Check_OutOfWorldBounds(state->player.pos)) {
+		return connectivity;
+	}
+
+	Clear_BitGrid(&state->walkable_mask);
+	for (int x = 0; x < Get_WorldScreenWidth(); x++) {
+		for (int y = 0; y < Get_WorldScreenHeight(); y++) {
+			if (state->world_tiles[x][y].data->type != TileType_SOLID) {
+				Set_BitGridCell(&state->walkable_mask, x, y, true);
+			}
+		}
+	}
+
+	Clear_BitGrid(&state->reachable_mask);
+	Set_BitGridCell(&state->reachable_mask, state->player.pos.x, state->player.pos.y, true);
+	connectivity.staircase_distance = Flood_BitGrid(&state->reachable_mask, &state->walkable_mask, &state->frontier_mask, &state->scratch_mask, &state->floor_arena, state->staircase_pos.x, state->staircase_pos.y);
 
-	Update_GameLog(&state->game_log, LOGMSG_PLR_NEW_FLOOR, state->current_floor);
+	connectivity.reachable_area = Count_BitGridCells(&state->reachable_mask);
+	return connectivity;
 }
 
 static void Populate_Rooms(game_state_t *state) {
@@ -207,48 +565,45 @@ static void Populate_Rooms(game_state_t *state) {
 	assert(state->num_rooms_created >= MIN_ROOMS);
 
 	// Choose a random room for the player spawn (except the last room created which is reserved for staircase room).
-	const int player_spawn_room_index = rand() % (state->num_rooms_created - 1);
+	const int player_spawn_room_index = rand_r(&state->rng_state) % (state->num_rooms_created - 1);
 
 	for (int i = 0; i < state->num_rooms_created - 1; i++) {
 		if (i == player_spawn_room_index) {
-			coord_t pos = NewCoord(
-				state->rooms[i].TL_corner.x + ((state->rooms[i].TR_corner.x - state->rooms[i].TL_corner.x) / 2),
-				state->rooms[i].TR_corner.y + ((state->rooms[i].BR_corner.y - state->rooms[i].TR_corner.y) / 2)
-			);
-			Try_SetPlayerPos(state, pos);
+			Try_SetPlayerPos(state, Get_RoomCenter(&state->rooms[i]));
 			continue;
 		}
 
-		// Create gold, food, and enemies in rooms.
+		// Create gold, food, and enemies in rooms (rooms that aren't hollow squares, such as cave areas, may contain walls or void).
 		for (int x = state->rooms[i].TL_corner.x + 1; x < state->rooms[i].TR_corner.x; x++) {
 			for (int y = state->rooms[i].TL_corner.y + 1; y < state->rooms[i].BL_corner.y; y++) {
-				int val = (rand() % 100) + 1;
+				if (state->world_tiles[x][y].data != GetTileData(TileSlug_GROUND) || state->world_tiles[x][y].enemy_occupier != ENEMY_NONE) {
+					continue;
+				}
+
+				int val = (rand_r(&state->rng_state) % 100) + 1;
 
 				switch (val) {
 					case 1:
-					case 2:;
-						enemy_t *enemy = NULL;
+					case 2:
 						if (val == 1) {
-							enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_ZOMBIE), NewCoord(x, y));
+							Spawn_Enemy(state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(x, y));
 						} else /*if (val == 2)*/ {
-							enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_WEREWOLF), NewCoord(x, y));
+							Spawn_Enemy(state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(x, y));
 						}
-						Update_WorldTileEnemyOccupier(state->world_tiles, enemy->pos, enemy);
-						AddToEnemyList(&state->enemy_list, enemy);
 						break;
 					case 3:
 					case 4:
-						Update_WorldTile(state->world_tiles, NewCoord(x, y), GetTileData(TileSlug_GOLD));
+						Update_WorldTile(state, NewCoord(x, y), GetTileData(TileSlug_GOLD));
 						break;
 					case 5: 
 					case 6:
-						Update_WorldTile(state->world_tiles, NewCoord(x, y), GetTileData(TileSlug_BIGGOLD));
+						Update_WorldTile(state, NewCoord(x, y), GetTileData(TileSlug_BIGGOLD));
 						break;
 					case 7:
-						Update_WorldTileItemOccupier(state->world_tiles, NewCoord(x, y), GetItem(ItmSlug_SMALLFOOD));
+						Update_WorldTileItemOccupier(state, NewCoord(x, y), GetItem(ItmSlug_SMALLFOOD));
 						break;
 					case 8:
-						Update_WorldTileItemOccupier(state->world_tiles, NewCoord(x, y), GetItem(ItmSlug_BIGFOOD));
+						Update_WorldTileItemOccupier(state, NewCoord(x, y), GetItem(ItmSlug_BIGFOOD));
 						break;
 					default:
 						break;
@@ -259,29 +614,52 @@ static void Populate_Rooms(game_state_t *state) {
 
 	// Spawn staircase in the last room created (tends to be near center of map due to dungeon creation algorithm).
 	const int last_room = state->num_rooms_created - 1;
-	coord_t pos = NewCoord(
-		state->rooms[last_room].TL_corner.x + ((state->rooms[last_room].TR_corner.x - state->rooms[last_room].TL_corner.x) / 2),
-		state->rooms[last_room].TR_corner.y + ((state->rooms[last_room].BR_corner.y - state->rooms[last_room].TR_corner.y) / 2)
-	);
+	coord_t pos = Get_RoomCenter(&state->rooms[last_room]);
 	// TODO: staircase may spawn ontop of enemy, causing the enemy to appear ontop of a staircase. Find fix.
-	Update_WorldTile(state->world_tiles, pos, GetTileData(TileSlug_STAIRCASE));
+	Update_WorldTile(state, pos, GetTileData(TileSlug_STAIRCASE));
+	state->staircase_pos = pos;
 }
 
-enemy_t* InitCreate_Enemy(const enemy_data_t *enemy_data, coord_t pos) {
+enemy_t Create_Enemy(const enemy_data_t *enemy_data, coord_t pos) {
 	assert(enemy_data != NULL);
 
-	enemy_t *enemy = malloc(sizeof(*enemy));
-	assert(enemy != NULL);
+	enemy_t enemy;
 
-	enemy->data = enemy_data;
-	enemy->curr_health = enemy->data->max_health;
-	enemy->pos = pos;
-	enemy->is_alive = true;
-	enemy->loot = GetItem(ItmSlug_NONE);
+	enemy.data = enemy_data;
+	enemy.curr_health = enemy.data->max_health;
+	enemy.pos = pos;
+	enemy.is_alive = true;
+	enemy.loot = GetItem(ItmSlug_NONE);
 
 	return enemy;
 }
 
+int Spawn_Enemy(game_state_t *state, const enemy_data_t *enemy_data, coord_t pos) {
+	assert(state != NULL);
+
+	const int enemy_index = AddTo_EnemyPool(&state->enemy_pool, Create_Enemy(enemy_data, pos));
+	Update_WorldTileEnemyOccupier(state, pos, enemy_index);
+	return enemy_index;
+}
+
+void Kill_Enemy(game_state_t *state, int enemy_index) {
+	assert(state != NULL);
+
+	enemy_t *enemy = Get_PoolEnemy(&state->enemy_pool, enemy_index);
+	assert(enemy->is_alive);
+	Update_WorldTileEnemyOccupier(state, enemy->pos, ENEMY_NONE);
+
+	// The enemy's loot is left where it died, unless an item is already there.
+	if (enemy->loot != GetItem(ItmSlug_NONE) && state->world_tiles[enemy->pos.x][enemy->pos.y].item_occupier == NULL) {
+		Update_WorldTileItemOccupier(state, enemy->pos, enemy->loot);
+		Log_GameEvent(&state->game_log, LogEvent_ENEMY_DROP_LOOT, enemy->data->name, enemy->loot->name);
+	}
+
+	// The slot is reused by the next enemy spawned, so the enemy must not be referred to again.
+	Unschedule_Actor(&state->enemy_scheduler, enemy_index);
+	RemoveFrom_EnemyPool(&state->enemy_pool, enemy_index);
+}
+
 player_t Create_Player(void) {
 	player_t player;
 
@@ -302,6 +680,7 @@ player_t Create_Player(void) {
 	player.stats.curr_mana = 10;
 
 	player.stats.max_vision = PLAYER_MAX_VISION;
+	player.stats.speed = PLAYER_SPEED;
 
 	player.stats.s_str = 1;
 	player.stats.s_def = 1;
@@ -333,19 +712,17 @@ int Get_WorldScreenHeight() {
 	return GEO_screen_height() - BOTTOM_PANEL_OFFSET;
 }
 
-static void Draw_UI(const game_state_t *state) {
+static void Draw_UI(game_state_t *state) {
 	const int terminal_w = GEO_screen_width();
 	const int terminal_h = GEO_screen_height();
 
 	// Draw bottom panel line.
 	GEO_draw_line(0, terminal_h - 6, terminal_w - 1, terminal_h - 6, Clr_MAGENTA, '_');
 
-	// Draw last 5 game log lines.
-	GEO_drawf(0, terminal_h - 5, Clr_WHITE, "* %s", state->game_log.line5);
-	GEO_drawf(0, terminal_h - 4, Clr_WHITE, "* %s", state->game_log.line4);
-	GEO_drawf(0, terminal_h - 3, Clr_WHITE, "* %s", state->game_log.line3);
-	GEO_drawf(0, terminal_h - 2, Clr_WHITE, "* %s", state->game_log.line2);
-	GEO_drawf(0, terminal_h - 1, Clr_WHITE, "* %s", state->game_log.line1);
+	// Draw the newest game log lines, newest at the bottom.
+	for (int i = 0; i < LOG_LINES_SHOWN; i++) {
+		GEO_drawf(0, terminal_h - 1 - i, Clr_WHITE, "* %s", Get_GameLogPanelLine(&state->game_log, i));
+	}
 
 	// Draw right-hand panel info.
 	{
@@ -394,6 +771,11 @@ static void Draw_UI(const game_state_t *state) {
 		}
 
 		// Debug info.
+		GEO_drawf(x, terminal_h - 11, Clr_MAGENTA, " - fov us: %.1f", state->debug_fov_usec);
+		GEO_drawf(x, terminal_h - 10, Clr_MAGENTA, " - awake: %d, asleep: %d", state->enemy_pool.num_awake, state->enemy_pool.num_active - state->enemy_pool.num_awake);
+		GEO_drawf(x, terminal_h - 9, Clr_MAGENTA, " - arena KB: %d (peak %d)", (int)(state->floor_arena.high_water / 1024), (int)(state->floor_arena.peak / 1024));
+		GEO_drawf(x, terminal_h - 8, Clr_MAGENTA, " - enemies: %d", state->enemy_pool.num_active);
+		GEO_drawf(x, terminal_h - 7, Clr_MAGENTA, " - reachable: %d, stairs: %d", state->connectivity.reachable_area, state->connectivity.staircase_distance);
 		GEO_drawf(x, terminal_h - 5, Clr_MAGENTA, " - player xy: (%d, %d)", state->player.pos.x, state->player.pos.y);
 		GEO_drawf(x, terminal_h - 4, Clr_MAGENTA, " - rc(s): %d", state->debug_rcs);
 		GEO_drawf(x, terminal_h - 3, Clr_MAGENTA, " - seed: %d", (int)state->debug_seed);
@@ -403,18 +785,14 @@ static void Draw_UI(const game_state_t *state) {
 }
 
 void Process(game_state_t *state) {
-	const int world_screen_w = Get_WorldScreenWidth();
-	const int world_screen_h = Get_WorldScreenHeight();
+	// Work out what the player can see from where they stand.
+	Update_FieldOfView(state);
 
 	// Clear drawn elements from screen.
 	GEO_clear_screen();
 
 	// Draw all world tiles.
-	for (int x = 0; x < world_screen_w; x++) {
-		for (int y = 0; y < world_screen_h; y++) {
-			Apply_Vision(state, NewCoord(x, y));
-		}
-	}
+	Draw_World(state);
 
 	// Draw player.
 	GEO_draw_char(state->player.pos.x, state->player.pos.y, state->player.color, state->player.sprite);
@@ -465,6 +843,9 @@ static bool Perform_PlayerLogic(game_state_t *state) {
 			case 'f':
 				state->fog_of_war = !state->fog_of_war;
 				return false;
+			case 'l':
+				Draw_LogScreen(state);
+				return false;
 			case 'q':
 				g_process_over = true;
 				return false;
@@ -521,50 +902,47 @@ static void Perform_WorldLogic(game_state_t *state, coord_t player_old_pos) {
 				int amt = 0;
 
 				if (curr_world_tile->data->sprite == SPR_GOLD) {
-					amt = (rand() % 4) + 1;
+					amt = (rand_r(&state->rng_state) % 4) + 1;
 				} else if (curr_world_tile->data->sprite == SPR_BIGGOLD) {
-					amt = (rand() % 5) + 5;
+					amt = (rand_r(&state->rng_state) % 5) + 5;
 				}
 
 				state->player.stats.num_gold += amt;
 				if (amt == 1) {
-					Update_GameLog(&state->game_log, LOGMSG_PLR_GET_GOLD_SINGLE, amt);
+					Log_GameEvent(&state->game_log, LogEvent_PLR_GET_GOLD_SINGLE, amt);
 				} else {
-					Update_GameLog(&state->game_log, LOGMSG_PLR_GET_GOLD_PLURAL, amt);
+					Log_GameEvent(&state->game_log, LogEvent_PLR_GET_GOLD_PLURAL, amt);
 				}
-				Update_WorldTile(state->world_tiles, state->player.pos, GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, state->player.pos, GetTileData(TileSlug_GROUND));
 				break;
 			}
 
 			// All other items are "picked up" (removed from world) if the player has room in their inventory.
 			if (AddTo_Inventory(&state->player, curr_world_tile->item_occupier)) {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_GET_ITEM, curr_world_tile->item_occupier->name);
-				Update_WorldTileItemOccupier(state->world_tiles, state->player.pos, NULL);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_GET_ITEM, curr_world_tile->item_occupier->name);
+				Update_WorldTileItemOccupier(state, state->player.pos, NULL);
 			} else {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_INVENTORY_FULL);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_INVENTORY_FULL);
 			}
 			break;
 		case TileType_ENEMY:;
-			enemy_t *attackedEnemy = curr_world_tile->enemy_occupier;
+			enemy_t *attackedEnemy = Get_PoolEnemy(&state->enemy_pool, curr_world_tile->enemy_occupier);
 			attackedEnemy->curr_health--;
-			Update_GameLog(&state->game_log, LOGMSG_PLR_DMG_ENEMY, attackedEnemy->data->name, 1);
+			Log_GameEvent(&state->game_log, LogEvent_PLR_DMG_ENEMY, attackedEnemy->data->name, 1);
 
 			if (attackedEnemy->curr_health <= 0) {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_KILL_ENEMY, attackedEnemy->data->name);
-				attackedEnemy->is_alive = false;
+				Log_GameEvent(&state->game_log, LogEvent_PLR_KILL_ENEMY, attackedEnemy->data->name);
 				state->player.stats.enemies_slain++;
-				Update_WorldTileEnemyOccupier(state->world_tiles, attackedEnemy->pos, NULL);
-			} else {
-				state->player.stats.curr_health--;
-				Update_GameLog(&state->game_log, LOGMSG_ENEMY_DMG_PLR, attackedEnemy->data->name, 1);
+				Kill_Enemy(state, curr_world_tile->enemy_occupier);
 			}
+			// A surviving enemy strikes back with its own next action, like every other enemy next to the player.
 
 			// Moving into any enemy results in no movement from the player.
 			state->player.pos = player_old_pos;
 			break;
 		case TileType_SPECIAL:
 			if (curr_world_tile->data->sprite == SPR_STAIRCASE) {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_INTERACT_STAIRCASE);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_INTERACT_STAIRCASE);
 				state->floor_complete = true;
 			}
 
@@ -573,23 +951,27 @@ static void Perform_WorldLogic(game_state_t *state, coord_t player_old_pos) {
 			break;
 		case TileType_NPC:
 			if (curr_world_tile->data->sprite == SPR_MERCHANT) {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_TALK_MERCHANT);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_TALK_MERCHANT);
 				state->player.current_npc_target = SPR_MERCHANT;
 			}
 			// Moving into an NPC results in no movement from the player.
 			state->player.pos = player_old_pos;
 			break;
 		default:
-			if (state->game_log.line1[0] != ' ' 
-				|| state->game_log.line2[0] != ' ' 
-				|| state->game_log.line3[0] != ' ' 
-				|| state->game_log.line4[0] != ' ' 
-				|| state->game_log.line5[0] != ' ') {
-				Update_GameLog(&state->game_log, LOGMSG_EMPTY_SPACE);
-			}
+			// Quiet turns scroll old messages out of the bottom panel.
+			Scroll_GameLogPanel(&state->game_log);
 			break;
 	}
 
+	// Enemies chase and attack the player, unless the player is leaving the floor.
+	if (!state->floor_complete) {
+		Update_ActiveRegion(state);
+		Update_FlowField(state);
+		Update_EnemyTurns(state);
+	}
+
+	Record_SessionTurn(state);
+
 	if (state->player.stats.curr_health <= 0) {
 		// GAME OVER.
 		Draw_DeathScreen(state);
@@ -597,6 +979,24 @@ static void Perform_WorldLogic(game_state_t *state, coord_t player_old_pos) {
 	}
 }
 
+static void Record_SessionTurn(const game_state_t *state) {
+	if (state->game_log.session_log == NULL) {
+		return;
+	}
+
+	const session_turn_t turn = {
+		.turn = state->game_turns + 1,
+		.floor = state->current_floor,
+		.health = state->player.stats.curr_health,
+		.max_health = state->player.stats.max_health,
+		.gold = state->player.stats.num_gold,
+		.x = state->player.pos.x,
+		.y = state->player.pos.y,
+		.enemies_awake = state->enemy_pool.num_awake
+	};
+	Push_SessionLogTurn(state->game_log.session_log, &turn);
+}
+
 static bool Check_RoomCollision(const tile_t **world_tiles, const room_t *room) {
 	assert(world_tiles != NULL);
 	assert(room != NULL);
@@ -634,143 +1034,582 @@ bool Check_OutOfWorldBounds(coord_t coord) {
 	return false;
 }
 
-static void Create_RoomsFromFile(game_state_t *state, const char *filename) {
-	assert(state != NULL);
+bool Init_MapTemplate(map_template_t *map_template, const char *filename) {
+	assert(map_template != NULL);
 	assert(filename != NULL);
 
-	// Attempt to open the file.
-	FILE *fp = NULL;
-	fp = fopen(filename, "r");
-	if (fp == NULL) {
-		return;
+	memset(map_template, 0, sizeof(*map_template));
+	map_template->player_spawn = NewCoord(-1, -1);
+	map_template->staircase_pos = NewCoord(-1, -1);
+
+	// Attempt to map the file.
+	map_file_t map;
+	if (!Open_MapFileData(&map, filename)) {
+		return false;
+	}
+
+	// Compiled maps are recognised by their magic bytes; anything else is treated as a txt map.
+	bool success = true;
+	if (map.size >= MAP_BINARY_MAGIC_SIZE && memcmp(map.data, MAP_BINARY_MAGIC, MAP_BINARY_MAGIC_SIZE) == 0) {
+		success = Decode_BinaryMapTemplate(map_template, (const unsigned char*)map.data, map.size);
 	} else {
-		// FIRST PASS: Get map length and height, use it to find the anchor point (Top-left corner) to center the map on.
-		coord_t anchor_centered_map_offset;
-		{
-			int lineNum = 0;
-			size_t len = 0;
-			char *line = NULL;
-			ssize_t read = 0;
-
-			int longest_line = 0;
-			while ((read = getline(&line, &len, fp)) != -1) {
-				longest_line = read;
-				lineNum++;
+		Find_MapFileLines(&map);
+		Decode_TextMapTemplate(map_template, &map);
+	}
+
+	Close_MapFile(&map);
+
+	if (!success) {
+		Cleanup_MapTemplate(map_template);
+	}
+	return success;
+}
+
+void Cleanup_MapTemplate(map_template_t *map_template) {
+	assert(map_template != NULL);
+
+	free(map_template->tiles);
+	free(map_template->enemy_spawns);
+	memset(map_template, 0, sizeof(*map_template));
+	map_template->player_spawn = NewCoord(-1, -1);
+	map_template->staircase_pos = NewCoord(-1, -1);
+}
+
+bool Save_MapTemplate(const map_template_t *map_template, const char *filename) {
+	assert(map_template != NULL);
+	assert(filename != NULL);
+	assert(map_template->width <= UINT16_MAX && map_template->height <= UINT16_MAX);
+
+	FILE *fp = fopen(filename, "wb");
+	if (fp == NULL) {
+		return false;
+	}
+
+	const int num_spawns = map_template->num_enemy_spawns + (map_template->player_spawn.x != -1) + (map_template->staircase_pos.x != -1);
+
+	// Header.
+	fwrite(MAP_BINARY_MAGIC, 1, MAP_BINARY_MAGIC_SIZE, fp);
+	Write_MapU16(fp, MAP_BINARY_VERSION);
+	Write_MapU16(fp, map_template->width);
+	Write_MapU16(fp, map_template->height);
+	Write_MapU16(fp, map_template->anchor.x);
+	Write_MapU16(fp, map_template->anchor.y);
+	Write_MapU16(fp, num_spawns);
+
+	// Tile rows, each as a run count followed by runs of identical (tile, item) pairs.
+	for (int y = 0; y < map_template->height; y++) {
+		int num_runs = 0;
+		for (int x = 0; x < map_template->width; x++) {
+			if (x == 0 || !Check_MapTemplateTilesEqual(map_template, NewCoord(x - 1, y), NewCoord(x, y))) {
+				num_runs++;
+			}
+		}
+		Write_MapU16(fp, num_runs);
+
+		for (int x = 0; x < map_template->width; ) {
+			int run_length = 1;
+			while (x + run_length < map_template->width && Check_MapTemplateTilesEqual(map_template, NewCoord(x, y), NewCoord(x + run_length, y))) {
+				run_length++;
 			}
 
-			anchor_centered_map_offset = NewCoord((Get_WorldScreenWidth() / 2) - ((longest_line - 1) / 2), ((Get_WorldScreenHeight() / 2) - (lineNum / 2)));
+			const tile_t *tile = &map_template->tiles[(x * map_template->height) + y];
+			Write_MapU16(fp, run_length);
+			fputc(Get_TileSlug(tile->data), fp);
+			fputc((tile->item_occupier != NULL) ? (int)tile->item_occupier->item_slug : MAP_BINARY_NO_ITEM, fp);
+			x += run_length;
 		}
+	}
 
-		// Reset file read-ptr.
-		rewind(fp);
+	// Spawn table.
+	if (map_template->player_spawn.x != -1) {
+		Write_MapSpawn(fp, MapSpawn_PLAYER, 0, map_template->player_spawn);
+	}
+	if (map_template->staircase_pos.x != -1) {
+		Write_MapSpawn(fp, MapSpawn_STAIRCASE, 0, map_template->staircase_pos);
+	}
+	for (int i = 0; i < map_template->num_enemy_spawns; i++) {
+		const enemy_spawn_t *spawn = &map_template->enemy_spawns[i];
+		Write_MapSpawn(fp, MapSpawn_ENEMY, spawn->data->enemy_slug, spawn->pos);
+	}
 
-		// SECOND PASS: generate the map relative to anchor point.
-		{
-			int lineNum = 0;
-			size_t len = 0;
-			char *line = NULL;
-			ssize_t read = 0;
+	const bool success = !ferror(fp);
+	return (fclose(fp) == 0) && success;
+}
 
-			while ((read = getline(&line, &len, fp)) != -1) {
-				for (int i = 0; i < read - 1; i++) {
-					coord_t pos = NewCoord(anchor_centered_map_offset.x + i, anchor_centered_map_offset.y + lineNum);
-					enemy_t *enemy = NULL;
-					const item_t *item = NULL;
-					const tile_data_t *tile_data = GetTileData(TileSlug_GROUND);
+static void Allocate_MapTemplate(map_template_t *map_template, int width, int height) {
+	assert(map_template != NULL);
+
+	map_template->width = width;
+	map_template->height = height;
+	map_template->anchor = NewCoord(-(width / 2), -(height / 2));
+
+	// Every cell not covered by the map (e.g. past the end of short lines) is ground.
+	const int num_tiles = width * height;
+	map_template->tiles = malloc(sizeof(*map_template->tiles) * (num_tiles > 0 ? num_tiles : 1));
+	assert(map_template->tiles != NULL);
+	for (int i = 0; i < num_tiles; i++) {
+		map_template->tiles[i].data = GetTileData(TileSlug_GROUND);
+		map_template->tiles[i].item_occupier = NULL;
+		map_template->tiles[i].enemy_occupier = ENEMY_NONE;
+	}
+}
 
-					// Replace any /n, /t, etc. with a whitespace character.
-					if (!isgraph(line[i])) {
-						line[i] = SPR_EMPTY;
-					}
+static void Add_MapTemplateEnemySpawn(map_template_t *map_template, const enemy_data_t *enemy_data, coord_t pos, int *enemy_spawns_capacity) {
+	assert(map_template != NULL);
+	assert(enemy_data != NULL);
+	assert(enemy_spawns_capacity != NULL);
 
-					switch (line[i]) {
-						case SPR_PLAYER:
-							Try_SetPlayerPos(state, pos);
-							line[i] = SPR_EMPTY;
-							break;
-						case SPR_WALL:
-							tile_data = GetTileData(TileSlug_WALL);
-							break;
-						case SPR_SMALLFOOD:
-							item = GetItem(ItmSlug_SMALLFOOD);
-							break;
-						case SPR_BIGFOOD:
-							item = GetItem(ItmSlug_BIGFOOD);
-							break;
-						case SPR_GOLD:
-							tile_data = GetTileData(TileSlug_GOLD);
-							break;
-						case SPR_BIGGOLD:
-							tile_data = GetTileData(TileSlug_BIGGOLD);
-							break;
-						case SPR_ZOMBIE:
-							enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_ZOMBIE), pos);
-							break;
-						case SPR_WEREWOLF:
-							enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_WEREWOLF), pos);
-							break;
-						case SPR_STAIRCASE:
-							tile_data = GetTileData(TileSlug_STAIRCASE);
-							break;
-						case SPR_MERCHANT:
-							tile_data = GetTileData(TileSlug_MERCHANT);
-							break;
-						case _UNITY_VOID_SPRITE:
-							tile_data = GetTileData(TileSlug_VOID);
-						default:
-							break;
-					}
+	if (map_template->num_enemy_spawns == *enemy_spawns_capacity) {
+		*enemy_spawns_capacity = (*enemy_spawns_capacity > 0) ? *enemy_spawns_capacity * 2 : 16;
+		map_template->enemy_spawns = realloc(map_template->enemy_spawns, sizeof(*map_template->enemy_spawns) * *enemy_spawns_capacity);
+		assert(map_template->enemy_spawns != NULL);
+	}
 
-					if (enemy != NULL) {
-						AddToEnemyList(&state->enemy_list, enemy);
-					}
+	enemy_spawn_t *spawn = &map_template->enemy_spawns[map_template->num_enemy_spawns++];
+	spawn->data = enemy_data;
+	spawn->pos = pos;
+}
 
-					Update_WorldTile(state->world_tiles, pos, tile_data);
-					Update_WorldTileItemOccupier(state->world_tiles, pos, item);
-					Update_WorldTileEnemyOccupier(state->world_tiles, pos, enemy);
-				}
-				line = NULL;
-				lineNum++;
+static void Decode_TextMapTemplate(map_template_t *map_template, const map_file_t *map) {
+	assert(map_template != NULL);
+	assert(map != NULL);
+
+	Allocate_MapTemplate(map_template, map->longest_line, map->num_lines);
+	int enemy_spawns_capacity = 0;
+
+	// Decode every sprite straight from the mapped file with a single table lookup each.
+	for (int y = 0; y < map->num_lines; y++) {
+		const map_line_t *line = &map->lines[y];
+
+		for (int x = 0; x < line->length; x++) {
+			tile_t *tile = &map_template->tiles[(x * map_template->height) + y];
+			const sprite_decoding_t *decoding = GetSpriteDecoding(line->chars[x]);
+
+			tile->data = GetTileData(decoding->tile_slug);
+			tile->item_occupier = (decoding->item_slug != ItmSlug_NONE) ? GetItem(decoding->item_slug) : NULL;
+
+			if (decoding->is_player) {
+				map_template->player_spawn = NewCoord(x, y);
+			} else if (decoding->is_enemy) {
+				Add_MapTemplateEnemySpawn(map_template, GetEnemyData(decoding->enemy_slug), NewCoord(x, y), &enemy_spawns_capacity);
+			} else if (decoding->tile_slug == TileSlug_STAIRCASE) {
+				map_template->staircase_pos = NewCoord(x, y);
 			}
-			free(line);
-			fclose(fp);
 		}
 	}
 }
 
-static void Create_RoomsRecursively(game_state_t *state, coord_t room_pos, int room_radius, int max_rooms) {
-	assert(state != NULL);
+static bool Decode_BinaryMapTemplate(map_template_t *map_template, const unsigned char *data, size_t size) {
+	assert(map_template != NULL);
+	assert(data != NULL);
+
+	map_reader_t reader = {.data = data, .size = size, .pos = MAP_BINARY_MAGIC_SIZE, .failed = false};
+
+	// Header.
+	const int version = Read_MapU16(&reader);
+	const int width = Read_MapU16(&reader);
+	const int height = Read_MapU16(&reader);
+	const int anchor_x = (int16_t)Read_MapU16(&reader);
+	const int anchor_y = (int16_t)Read_MapU16(&reader);
+	const int num_spawns = Read_MapU16(&reader);
+	if (reader.failed || version != MAP_BINARY_VERSION) {
+		return false;
+	}
 
-	const int ATTEMPTS_PER_ROOM = 5;
+	Allocate_MapTemplate(map_template, width, height);
+	map_template->anchor = NewCoord(anchor_x, anchor_y);
 
-	// Create the latest defined room.
-	Generate_Room(state->world_tiles, &state->rooms[state->num_rooms_created]);
-	state->num_rooms_created++;
+	// Tile rows. Every row's runs must add up to exactly the map's width.
+	for (int y = 0; y < height && !reader.failed; y++) {
+		const int num_runs = Read_MapU16(&reader);
+		int x = 0;
 
-	coord_t old_room_pos = room_pos;
-	int rand_direction = rand() % 4;
-	int new_room_radius = Get_NextRoomRadius();
+		for (int run = 0; run < num_runs && !reader.failed; run++) {
+			const int run_length = Read_MapU16(&reader);
+			const int tile_slug = Read_MapU8(&reader);
+			const int item_slug = Read_MapU8(&reader);
+			if (reader.failed || run_length > width - x || tile_slug >= TileSlug_COUNT || (item_slug >= ItmSlug_COUNT && item_slug != MAP_BINARY_NO_ITEM)) {
+				return false;
+			}
 
-	// Try to initialise a new room with a connecting corridor, until all retry iterations are used up OR max rooms are reached.
-	for (int i = 0; i < ATTEMPTS_PER_ROOM; i++) {
-		if (state->num_rooms_created >= max_rooms) {
-			return;
+			const tile_t tile = {
+				.data = GetTileData(tile_slug),
+				.enemy_occupier = ENEMY_NONE,
+				.item_occupier = (item_slug != MAP_BINARY_NO_ITEM) ? GetItem(item_slug) : NULL
+			};
+			for (int i = 0; i < run_length; i++, x++) {
+				map_template->tiles[(x * height) + y] = tile;
+			}
 		}
 
-		// Make sure the next random direction is different from the last attempt's direction.
-		if (i > 0) {
-			rand_direction = ((rand_direction + 1) % 4);
+		if (x != width) {
+			return false;
 		}
+	}
 
-		// Get the new room's position coordinates.
-		coord_t new_room_pos = old_room_pos;
-		switch (rand_direction) {
-			case Dir_UP:
-				new_room_pos.y = old_room_pos.y - (room_radius * 2) - new_room_radius;
-				break;
-			case Dir_DOWN:
-				new_room_pos.y = old_room_pos.y + (room_radius * 2) + new_room_radius;
-				break;
+	// Spawn table.
+	int enemy_spawns_capacity = 0;
+	for (int i = 0; i < num_spawns && !reader.failed; i++) {
+		const int kind = Read_MapU8(&reader);
+		const int slug = Read_MapU8(&reader);
+		const int x = Read_MapU16(&reader);
+		const int y = Read_MapU16(&reader);
+		const coord_t pos = NewCoord(x, y);
+		if (reader.failed || pos.x >= width || pos.y >= height) {
+			return false;
+		}
+
+		if (kind == MapSpawn_PLAYER) {
+			map_template->player_spawn = pos;
+		} else if (kind == MapSpawn_STAIRCASE) {
+			map_template->staircase_pos = pos;
+		} else if (kind == MapSpawn_ENEMY && slug < EnmySlug_COUNT) {
+			Add_MapTemplateEnemySpawn(map_template, GetEnemyData(slug), pos, &enemy_spawns_capacity);
+		} else {
+			return false;
+		}
+	}
+
+	// Trailing bytes mean the file isn't the map it claims to be.
+	return !reader.failed && reader.pos == reader.size;
+}
+
+static int Read_MapU8(map_reader_t *reader) {
+	assert(reader != NULL);
+
+	if (reader->failed || reader->pos + 1 > reader->size) {
+		reader->failed = true;
+		return 0;
+	}
+	return reader->data[reader->pos++];
+}
+
+static int Read_MapU16(map_reader_t *reader) {
+	const int low = Read_MapU8(reader);
+	const int high = Read_MapU8(reader);
+	return low | (high << 8);
+}
+
+static void Write_MapU16(FILE *fp, int value) {
+	assert(fp != NULL);
+
+	fputc(value & 0xFF, fp);
+	fputc((value >> 8) & 0xFF, fp);
+}
+
+static void Write_MapSpawn(FILE *fp, map_spawn_en kind, int slug, coord_t pos) {
+	assert(fp != NULL);
+
+	fputc(kind, fp);
+	fputc(slug, fp);
+	Write_MapU16(fp, pos.x);
+	Write_MapU16(fp, pos.y);
+}
+
+static int Get_TileSlug(const tile_data_t *tile_data) {
+	assert(tile_data != NULL);
+
+	for (int slug = 0; slug < TileSlug_COUNT; slug++) {
+		if (GetTileData(slug) == tile_data) {
+			return slug;
+		}
+	}
+
+	assert(false);
+	return TileSlug_VOID;
+}
+
+static bool Check_MapTemplateTilesEqual(const map_template_t *map_template, coord_t a, coord_t b) {
+	assert(map_template != NULL);
+
+	const tile_t *tile_a = &map_template->tiles[(a.x * map_template->height) + a.y];
+	const tile_t *tile_b = &map_template->tiles[(b.x * map_template->height) + b.y];
+	return tile_a->data == tile_b->data && tile_a->item_occupier == tile_b->item_occupier;
+}
+
+static void Create_RoomsFromTemplate(game_state_t *state, const map_template_t *map_template) {
+	assert(state != NULL);
+	assert(map_template != NULL);
+
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// The template's anchor places its top-left corner relative to the center of the world.
+	const coord_t anchor = NewCoord((world_screen_w / 2) + map_template->anchor.x, (world_screen_h / 2) + map_template->anchor.y);
+
+	// Copy each of the template's columns into the world in one go, clipped to the world's bounds.
+	const int first_y = (anchor.y < TOP_PANEL_OFFSET) ? TOP_PANEL_OFFSET - anchor.y : 0;
+	const int last_y = MIN(map_template->height, world_screen_h - anchor.y);
+	for (int x = 0; x < map_template->width && first_y < last_y; x++) {
+		const int world_x = anchor.x + x;
+		if (world_x < 0 || world_x >= world_screen_w) {
+			continue;
+		}
+
+		Copy_WorldTileSpan(state, NewCoord(world_x, anchor.y + first_y), &map_template->tiles[(x * map_template->height) + first_y], last_y - first_y);
+	}
+
+	for (int i = 0; i < map_template->num_enemy_spawns; i++) {
+		const enemy_spawn_t *spawn = &map_template->enemy_spawns[i];
+		const coord_t pos = NewCoord(anchor.x + spawn->pos.x, anchor.y + spawn->pos.y);
+		if (Check_OutOfWorldBounds(pos)) {
+			continue;
+		}
+
+		Spawn_Enemy(state, spawn->data, pos);
+	}
+
+	if (map_template->player_spawn.x != -1) {
+		Try_SetPlayerPos(state, NewCoord(anchor.x + map_template->player_spawn.x, anchor.y + map_template->player_spawn.y));
+	}
+
+	if (map_template->staircase_pos.x != -1) {
+		const coord_t staircase_pos = NewCoord(anchor.x + map_template->staircase_pos.x, anchor.y + map_template->staircase_pos.y);
+		if (!Check_OutOfWorldBounds(staircase_pos)) {
+			state->staircase_pos = staircase_pos;
+		}
+	}
+}
+
+static int Create_RoomsBSP(game_state_t *state, const room_t *area, int num_rooms) {
+	assert(state != NULL);
+	assert(area != NULL);
+	assert(num_rooms >= 1);
+
+	const int area_w = area->TR_corner.x - area->TL_corner.x + 1;
+	const int area_h = area->BL_corner.y - area->TL_corner.y + 1;
+	const bool split_vertically = (area_w >= area_h);
+	const int split_length = split_vertically ? area_w : area_h;
+
+	// Leaf partitions (or partitions too small to split any further) hold a single room, with a gap to the partition's edges so neighbouring rooms never share walls.
+	if (num_rooms == 1 || split_length < MIN_ROOM_SIZE * 2) {
+		const int max_radius = (MIN(area_w, area_h) - 3) / 2;
+		assert(max_radius >= 1);
+
+		const int next_radius = Get_NextRoomRadius(state);
+		const int radius = CLAMP(next_radius, 1, max_radius);
+		const int slack_x = area_w - 3 - (radius * 2);
+		const int slack_y = area_h - 3 - (radius * 2);
+		coord_t pos = NewCoord(
+			area->TL_corner.x + 1 + radius + (rand_r(&state->rng_state) % (slack_x + 1)),
+			area->TL_corner.y + 1 + radius + (rand_r(&state->rng_state) % (slack_y + 1))
+		);
+
+		// Corridors between partitions are carved along each room's center row and column, so any prefab's doors will be reached.
+		const int room_index = state->num_rooms_created++;
+		Define_Room(&state->rooms[room_index], pos, radius);
+		const prefab_t *prefab = Get_RandomPrefab(state, radius, 0);
+		if (prefab != NULL) {
+			Generate_PrefabRoom(state, prefab, &state->rooms[room_index]);
+		} else {
+			Generate_Room(state, &state->rooms[room_index]);
+		}
+		return room_index;
+	}
+
+	// Split the partition in proportion to the number of rooms each half will hold, so every room gets a similar amount of space.
+	const int first_num_rooms = num_rooms / 2;
+	const int jitter = (rand_r(&state->rng_state) % 3) - 1;
+	const int first_length = CLAMP((split_length * first_num_rooms / num_rooms) + jitter, MIN_ROOM_SIZE, split_length - MIN_ROOM_SIZE);
+
+	room_t first_area = *area;
+	room_t second_area = *area;
+	if (split_vertically) {
+		first_area.TR_corner.x = first_area.BR_corner.x = area->TL_corner.x + first_length - 1;
+		second_area.TL_corner.x = second_area.BL_corner.x = area->TL_corner.x + first_length;
+	} else {
+		first_area.BL_corner.y = first_area.BR_corner.y = area->TL_corner.y + first_length - 1;
+		second_area.TL_corner.y = second_area.TR_corner.y = area->TL_corner.y + first_length;
+	}
+
+	const int first_room = Create_RoomsBSP(state, &first_area, first_num_rooms);
+	const int second_room = Create_RoomsBSP(state, &second_area, num_rooms - first_num_rooms);
+
+	Generate_CorridorBetween(state, Get_RoomCenter(&state->rooms[first_room]), Get_RoomCenter(&state->rooms[second_room]));
+
+	return (rand_r(&state->rng_state) % 2 == 0) ? first_room : second_room;
+}
+
+static void Generate_CorridorBetween(game_state_t *state, coord_t from, coord_t to) {
+	assert(state != NULL);
+
+	coord_t pos = from;
+	while (true) {
+		// Carve the corridor, walling off any void around it.
+		if (state->world_tiles[pos.x][pos.y].data->type == TileType_SOLID || state->world_tiles[pos.x][pos.y].data == GetTileData(TileSlug_VOID)) {
+			Update_WorldTile(state, pos, GetTileData(TileSlug_GROUND));
+		}
+		for (int dx = -1; dx <= 1; dx++) {
+			for (int dy = -1; dy <= 1; dy++) {
+				coord_t adjacent = NewCoord(pos.x + dx, pos.y + dy);
+				if (!Check_OutOfWorldBounds(adjacent) && state->world_tiles[adjacent.x][adjacent.y].data == GetTileData(TileSlug_VOID)) {
+					Update_WorldTile(state, adjacent, GetTileData(TileSlug_WALL));
+				}
+			}
+		}
+
+		// Travel horizontally first, then vertically.
+		if (pos.x != to.x) {
+			pos.x += (to.x > pos.x) ? 1 : -1;
+		} else if (pos.y != to.y) {
+			pos.y += (to.y > pos.y) ? 1 : -1;
+		} else {
+			break;
+		}
+	}
+}
+
+static void Create_CaveRooms(game_state_t *state, int num_rooms) {
+	assert(state != NULL);
+	assert(num_rooms >= MIN_ROOMS);
+
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// The grids are only needed while the cave is generated, so they are released back to the floor arena afterwards.
+	const size_t arena_mark = Get_ArenaMark(&state->floor_arena);
+	bitgrid_t walls;
+	bitgrid_t scratch;
+	Init_BitGridInArena(&walls, &state->floor_arena, world_screen_w, world_screen_h);
+	Init_BitGridInArena(&scratch, &state->floor_arena, world_screen_w, world_screen_h);
+
+	// Randomly scatter walls, keeping the world's edges solid.
+	for (int y = 0; y < world_screen_h; y++) {
+		for (int x = 0; x < world_screen_w; x++) {
+			const bool is_edge = (x == 0 || y == 0 || x == world_screen_w - 1 || y == world_screen_h - 1);
+			if (is_edge || (rand_r(&state->rng_state) % 100) < CAVE_INITIAL_WALL_CHANCE) {
+				Set_BitGridCell(&walls, x, y, true);
+			}
+		}
+	}
+
+	// Smooth the noise into caverns.
+	for (int i = 0; i < CAVE_AUTOMATON_STEPS; i++) {
+		Step_BitGridAutomaton(&walls, &scratch, CAVE_BIRTH_LIMIT, CAVE_SURVIVAL_LIMIT);
+	}
+
+	// The open cell closest to the center of the world seeds the main cavern.
+	coord_t seed = NewCoord(-1, -1);
+	{
+		int closest_distance = world_screen_w + world_screen_h;
+		for (int y = 0; y < world_screen_h; y++) {
+			for (int x = 0; x < world_screen_w; x++) {
+				const int distance = abs(x - (world_screen_w / 2)) + abs(y - (world_screen_h / 2));
+				if (!Get_BitGridCell(&walls, x, y) && distance < closest_distance) {
+					closest_distance = distance;
+					seed = NewCoord(x, y);
+				}
+			}
+		}
+	}
+
+	if (seed.x == -1) {
+		// Every cell became a wall; carve out a single cavern around the center so the floor is still playable.
+		seed = NewCoord(world_screen_w / 2, world_screen_h / 2);
+		for (int y = seed.y - 2; y <= seed.y + 2; y++) {
+			for (int x = seed.x - 2; x <= seed.x + 2; x++) {
+				Set_BitGridCell(&walls, x, y, false);
+			}
+		}
+	}
+
+	// Flood fill the main cavern so that disconnected pockets are discarded.
+	bitgrid_t cavern;
+	Init_BitGridInArena(&cavern, &state->floor_arena, world_screen_w, world_screen_h);
+	Set_BitGridCell(&cavern, seed.x, seed.y, true);
+	Invert_BitGrid(&walls);
+	Flood_BitGrid(&cavern, &walls, &state->frontier_mask, &scratch, &state->floor_arena, -1, -1);
+
+	// Convert the cavern into world tiles; anything touching the cavern becomes its wall.
+	for (int x = 0; x < world_screen_w; x++) {
+		for (int y = 0; y < world_screen_h; y++) {
+			if (Get_BitGridCell(&cavern, x, y)) {
+				Update_WorldTile(state, NewCoord(x, y), GetTileData(TileSlug_GROUND));
+				continue;
+			}
+
+			bool touches_cavern = false;
+			for (int dx = -1; dx <= 1 && !touches_cavern; dx++) {
+				for (int dy = -1; dy <= 1 && !touches_cavern; dy++) {
+					touches_cavern = Get_BitGridCell(&cavern, x + dx, y + dy);
+				}
+			}
+			if (touches_cavern) {
+				Update_WorldTile(state, NewCoord(x, y), GetTileData(TileSlug_WALL));
+			}
+		}
+	}
+
+	// Mark out areas of the cavern to act as rooms, each centered on a distinct open cell.
+	const int cavern_area = Count_BitGridCells(&cavern);
+	for (int i = 0; i < num_rooms; i++) {
+		coord_t center;
+		bool center_taken;
+		do {
+			center = NewCoord(rand_r(&state->rng_state) % world_screen_w, rand_r(&state->rng_state) % world_screen_h);
+
+			// Centers only need to be distinct while the cavern has enough open cells for them.
+			center_taken = false;
+			for (int j = 0; j < i && i < cavern_area; j++) {
+				if (CoordsEqual(center, Get_RoomCenter(&state->rooms[j]))) {
+					center_taken = true;
+					break;
+				}
+			}
+		} while (!Get_BitGridCell(&cavern, center.x, center.y) || center_taken);
+
+		int radius = Get_NextRoomRadius(state);
+		do {
+			Define_Room(&state->rooms[i], center, radius--);
+		} while (radius > 0 && Check_RoomOutOfWorldBounds(&state->rooms[i]));
+	}
+	state->num_rooms_created = num_rooms;
+
+	Restore_ArenaMark(&state->floor_arena, arena_mark);
+}
+
+static void Create_RoomsRecursively(game_state_t *state, coord_t room_pos, int room_radius, const prefab_t *prefab, int max_rooms) {
+	assert(state != NULL);
+
+	const int ATTEMPTS_PER_ROOM = 5;
+
+	// Create the latest defined room.
+	if (prefab != NULL) {
+		Generate_PrefabRoom(state, prefab, &state->rooms[state->num_rooms_created]);
+	} else {
+		Generate_Room(state, &state->rooms[state->num_rooms_created]);
+	}
+	state->num_rooms_created++;
+
+	coord_t old_room_pos = room_pos;
+	int rand_direction = rand_r(&state->rng_state) % 4;
+	int new_room_radius = Get_NextRoomRadius(state);
+
+	// Try to initialise a new room with a connecting corridor, until all retry iterations are used up OR max rooms are reached.
+	for (int i = 0; i < ATTEMPTS_PER_ROOM; i++) {
+		if (state->num_rooms_created >= max_rooms) {
+			return;
+		}
+
+		// Make sure the next random direction is different from the last attempt's direction.
+		if (i > 0) {
+			rand_direction = ((rand_direction + 1) % 4);
+		}
+
+		// Prefab rooms can only be left through their doors.
+		if (prefab != NULL && !(prefab->door_mask & (1u << rand_direction))) {
+			continue;
+		}
+
+		// Get the new room's position coordinates.
+		coord_t new_room_pos = old_room_pos;
+		switch (rand_direction) {
+			case Dir_UP:
+				new_room_pos.y = old_room_pos.y - (room_radius * 2) - new_room_radius;
+				break;
+			case Dir_DOWN:
+				new_room_pos.y = old_room_pos.y + (room_radius * 2) + new_room_radius;
+				break;
 			case Dir_LEFT:
 				new_room_pos.x = old_room_pos.x - (room_radius * 2) - new_room_radius;
 				break;
@@ -781,11 +1620,15 @@ static void Create_RoomsRecursively(game_state_t *state, coord_t room_pos, int r
 				break;
 		}
 
-		// Define the new room.
+		// Define the new room, which may be a prefab with a door facing back towards this room.
 		Define_Room(&state->rooms[state->num_rooms_created], new_room_pos, new_room_radius);
+		const prefab_t *new_prefab = Get_RandomPrefab(state, new_room_radius, 1u << Get_OppositeDirection(rand_direction));
 
 		// Check that this new room doesnt collide with map boundaries or anything solid.
-		if (Check_RoomCollision((const tile_t **)state->world_tiles, &state->rooms[state->num_rooms_created])) {
+		const bool room_collides = (new_prefab != NULL)
+			? Check_PrefabCollision((const tile_t **)state->world_tiles, new_prefab, &state->rooms[state->num_rooms_created])
+			: Check_RoomCollision((const tile_t **)state->world_tiles, &state->rooms[state->num_rooms_created]);
+		if (room_collides) {
 			state->debug_rcs++;
 			continue;
 		}
@@ -797,67 +1640,165 @@ static void Create_RoomsRecursively(game_state_t *state, coord_t room_pos, int r
 		}
 
 		// Generate the corridor, connecting the last created room to the new one (new room's opening is marked with '?').
-		Generate_Corridor(state->world_tiles, old_room_pos, room_radius, rand_direction);
+		Generate_Corridor(state, old_room_pos, room_radius, rand_direction);
 
 		// Instantiate the new conjoined room.
-		Create_RoomsRecursively(state, new_room_pos, new_room_radius, max_rooms);
+		Create_RoomsRecursively(state, new_room_pos, new_room_radius, new_prefab, max_rooms);
 	}
 }
 
-static int Get_NextRoomRadius(void) {
-	return (rand() % 6) + 2;
+static const prefab_t* Get_RandomPrefab(game_state_t *state, int radius, unsigned int required_doors) {
+	assert(state != NULL);
+
+	// Without a library, no random numbers are drawn so floors stay the same as without prefab support.
+	if (state->prefab_library == NULL || state->prefab_library->num_prefabs == 0) {
+		return NULL;
+	}
+
+	if ((rand_r(&state->rng_state) % 100) >= PREFAB_ROOM_CHANCE) {
+		return NULL;
+	}
+
+	const int num_matches = Count_Prefabs(state->prefab_library, radius, required_doors);
+	if (num_matches == 0) {
+		return NULL;
+	}
+	return Get_Prefab(state->prefab_library, radius, required_doors, rand_r(&state->rng_state) % num_matches);
 }
 
-static void Generate_Corridor(tile_t **world_tiles, coord_t starting_room, int corridor_size, direction_en direction) {
+static bool Check_PrefabCollision(const tile_t **world_tiles, const prefab_t *prefab, const room_t *room) {
 	assert(world_tiles != NULL);
+	assert(prefab != NULL);
+	assert(room != NULL);
+
+	if (Check_RoomOutOfWorldBounds(room)) {
+		return true;
+	}
+
+	// Walk the set bits of each footprint row, so void parts of the prefab can overlap other rooms' surroundings.
+	for (int y = 0; y < prefab->layout.height; y++) {
+		uint32_t footprint = prefab->footprint_rows[y];
+		while (footprint != 0) {
+			const int x = __builtin_ctz(footprint);
+			footprint &= footprint - 1;
+
+			if (world_tiles[room->TL_corner.x + x][room->TL_corner.y + y].data->type == TileType_SOLID) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+static void Generate_PrefabRoom(game_state_t *state, const prefab_t *prefab, const room_t *room) {
+	assert(state != NULL);
+	assert(prefab != NULL);
+	assert(room != NULL);
+
+	const int r = prefab->radius;
+	const coord_t center = Get_RoomCenter(room);
+	const coord_t door_pos[4] = {
+		[Dir_UP] = NewCoord(center.x, center.y - r),
+		[Dir_DOWN] = NewCoord(center.x, center.y + r),
+		[Dir_LEFT] = NewCoord(center.x - r, center.y),
+		[Dir_RIGHT] = NewCoord(center.x + r, center.y)
+	};
+
+	// Remember which doors the connecting corridor marked before they are overwritten.
+	bool door_marked[4];
+	for (int dir = 0; dir < 4; dir++) {
+		door_marked[dir] = (state->world_tiles[door_pos[dir].x][door_pos[dir].y].data == GetTileData(TileSlug_OPENING));
+	}
+
+	for (int x = 0; x < prefab->layout.width; x++) {
+		if (prefab->column_length[x] == 0) {
+			continue;
+		}
+
+		Copy_WorldTileSpan(state, NewCoord(room->TL_corner.x + x, room->TL_corner.y + prefab->column_start[x]),
+			&prefab->layout.tiles[(x * prefab->layout.height) + prefab->column_start[x]], prefab->column_length[x]);
+	}
+
+	for (int i = 0; i < prefab->layout.num_enemy_spawns; i++) {
+		const enemy_spawn_t *spawn = &prefab->layout.enemy_spawns[i];
+		Spawn_Enemy(state, spawn->data, NewCoord(room->TL_corner.x + spawn->pos.x, room->TL_corner.y + spawn->pos.y));
+	}
+
+	for (int dir = 0; dir < 4; dir++) {
+		if (prefab->door_mask & (1u << dir)) {
+			Update_WorldTile(state, door_pos[dir], GetTileData(door_marked[dir] ? TileSlug_GROUND : TileSlug_WALL));
+		}
+	}
+}
+
+static direction_en Get_OppositeDirection(direction_en direction) {
+	switch (direction) {
+		case Dir_UP:
+			return Dir_DOWN;
+		case Dir_DOWN:
+			return Dir_UP;
+		case Dir_LEFT:
+			return Dir_RIGHT;
+		case Dir_RIGHT:
+		default:
+			return Dir_LEFT;
+	}
+}
+
+static int Get_NextRoomRadius(game_state_t *state) {
+	return (rand_r(&state->rng_state) % 6) + 2;
+}
+
+static void Generate_Corridor(game_state_t *state, coord_t starting_room, int corridor_size, direction_en direction) {
+	assert(state != NULL);
 
 	switch (direction) {
 		case Dir_UP:
 			// Create opening for THIS room
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x, starting_room.y - corridor_size), GetTileData(TileSlug_GROUND));
+			Update_WorldTile(state, NewCoord(starting_room.x, starting_room.y - corridor_size), GetTileData(TileSlug_GROUND));
 
 			// Connect rooms with the corridor sprites.
 			for (int i = 0; i < corridor_size; i++) {
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x - 1, starting_room.y - corridor_size - (i + 1)), GetTileData(TileSlug_WALL));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x, starting_room.y - corridor_size - (i + 1)), GetTileData(TileSlug_GROUND));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x + 1, starting_room.y - corridor_size - (i + 1)), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x - 1, starting_room.y - corridor_size - (i + 1)), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x, starting_room.y - corridor_size - (i + 1)), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(starting_room.x + 1, starting_room.y - corridor_size - (i + 1)), GetTileData(TileSlug_WALL));
 			}
 
 			// Create marked opening for the NEXT room.
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x, starting_room.y - (corridor_size * 2)), GetTileData(TileSlug_OPENING));
+			Update_WorldTile(state, NewCoord(starting_room.x, starting_room.y - (corridor_size * 2)), GetTileData(TileSlug_OPENING));
 			break;
 		case Dir_DOWN:
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x, starting_room.y + corridor_size), GetTileData(TileSlug_GROUND));
+			Update_WorldTile(state, NewCoord(starting_room.x, starting_room.y + corridor_size), GetTileData(TileSlug_GROUND));
 
 			for (int i = 0; i < corridor_size; i++) {
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x - 1, starting_room.y + corridor_size + (i + 1)), GetTileData(TileSlug_WALL));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x, starting_room.y + corridor_size + (i + 1)), GetTileData(TileSlug_GROUND));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x + 1, starting_room.y + corridor_size + (i + 1)), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x - 1, starting_room.y + corridor_size + (i + 1)), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x, starting_room.y + corridor_size + (i + 1)), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(starting_room.x + 1, starting_room.y + corridor_size + (i + 1)), GetTileData(TileSlug_WALL));
 			}
 
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x, starting_room.y + (corridor_size * 2)), GetTileData(TileSlug_OPENING));
+			Update_WorldTile(state, NewCoord(starting_room.x, starting_room.y + (corridor_size * 2)), GetTileData(TileSlug_OPENING));
 			break;
 		case Dir_LEFT:
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x - corridor_size, starting_room.y), GetTileData(TileSlug_GROUND));
+			Update_WorldTile(state, NewCoord(starting_room.x - corridor_size, starting_room.y), GetTileData(TileSlug_GROUND));
 
 			for (int i = 0; i < corridor_size; i++) {
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x - corridor_size - (i + 1), starting_room.y - 1), GetTileData(TileSlug_WALL));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x - corridor_size - (i + 1), starting_room.y), GetTileData(TileSlug_GROUND));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x - corridor_size - (i + 1), starting_room.y + 1), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x - corridor_size - (i + 1), starting_room.y - 1), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x - corridor_size - (i + 1), starting_room.y), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(starting_room.x - corridor_size - (i + 1), starting_room.y + 1), GetTileData(TileSlug_WALL));
 			}
 
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x - (corridor_size * 2), starting_room.y), GetTileData(TileSlug_OPENING));
+			Update_WorldTile(state, NewCoord(starting_room.x - (corridor_size * 2), starting_room.y), GetTileData(TileSlug_OPENING));
 			break;
 		case Dir_RIGHT:
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x + corridor_size, starting_room.y), GetTileData(TileSlug_GROUND));
+			Update_WorldTile(state, NewCoord(starting_room.x + corridor_size, starting_room.y), GetTileData(TileSlug_GROUND));
 
 			for (int i = 0; i < corridor_size; i++) {
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x + corridor_size + (i + 1), starting_room.y - 1), GetTileData(TileSlug_WALL));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x + corridor_size + (i + 1), starting_room.y), GetTileData(TileSlug_GROUND));
-				Update_WorldTile(world_tiles, NewCoord(starting_room.x + corridor_size + (i + 1), starting_room.y + 1), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x + corridor_size + (i + 1), starting_room.y - 1), GetTileData(TileSlug_WALL));
+				Update_WorldTile(state, NewCoord(starting_room.x + corridor_size + (i + 1), starting_room.y), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(starting_room.x + corridor_size + (i + 1), starting_room.y + 1), GetTileData(TileSlug_WALL));
 			}
 
-			Update_WorldTile(world_tiles, NewCoord(starting_room.x + (corridor_size * 2), starting_room.y), GetTileData(TileSlug_OPENING));
+			Update_WorldTile(state, NewCoord(starting_room.x + (corridor_size * 2), starting_room.y), GetTileData(TileSlug_OPENING));
 			break;
 		default:
 			break;
@@ -933,38 +1874,47 @@ static void Define_Room(room_t *room, coord_t pos, int radius) {
 	room->BR_corner.y = pos.y + radius;
 }
 
-static void Generate_Room(tile_t **world_tiles, const room_t *room) {
-	assert(world_tiles != NULL);
+static coord_t Get_RoomCenter(const room_t *room) {
+	assert(room != NULL);
+
+	return NewCoord(
+		room->TL_corner.x + ((room->TR_corner.x - room->TL_corner.x) / 2),
+		room->TR_corner.y + ((room->BR_corner.y - room->TR_corner.y) / 2)
+	);
+}
+
+static void Generate_Room(game_state_t *state, const room_t *room) {
+	assert(state != NULL);
 	assert(room != NULL);
 
 	//Connect corners with walls; marked tiles (?) become openings.
 	{
 		// Bottom and top walls.
 		for (int x = room->TL_corner.x; x <= room->TR_corner.x; x++) {
-			if (world_tiles[x][room->TL_corner.y].data != GetTileData(TileSlug_OPENING)) {
-				Update_WorldTile(world_tiles, NewCoord(x, room->TL_corner.y), GetTileData(TileSlug_WALL));
+			if (state->world_tiles[x][room->TL_corner.y].data != GetTileData(TileSlug_OPENING)) {
+				Update_WorldTile(state, NewCoord(x, room->TL_corner.y), GetTileData(TileSlug_WALL));
 			} else {
-				Update_WorldTile(world_tiles, NewCoord(x, room->TL_corner.y), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(x, room->TL_corner.y), GetTileData(TileSlug_GROUND));
 			}
 
-			if (world_tiles[x][room->BL_corner.y].data != GetTileData(TileSlug_OPENING)) {
-				Update_WorldTile(world_tiles, NewCoord(x, room->BL_corner.y), GetTileData(TileSlug_WALL));
+			if (state->world_tiles[x][room->BL_corner.y].data != GetTileData(TileSlug_OPENING)) {
+				Update_WorldTile(state, NewCoord(x, room->BL_corner.y), GetTileData(TileSlug_WALL));
 			} else {
-				Update_WorldTile(world_tiles, NewCoord(x, room->BL_corner.y), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(x, room->BL_corner.y), GetTileData(TileSlug_GROUND));
 			}
 		}
 
 		// Left and right walls.
 		for (int y = room->TR_corner.y; y <= room->BR_corner.y; y++) {
-			if (world_tiles[room->TR_corner.x][y].data != GetTileData(TileSlug_OPENING)) {
-				Update_WorldTile(world_tiles, NewCoord(room->TR_corner.x, y), GetTileData(TileSlug_WALL));
+			if (state->world_tiles[room->TR_corner.x][y].data != GetTileData(TileSlug_OPENING)) {
+				Update_WorldTile(state, NewCoord(room->TR_corner.x, y), GetTileData(TileSlug_WALL));
 			} else {
-				Update_WorldTile(world_tiles, NewCoord(room->TR_corner.x, y), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(room->TR_corner.x, y), GetTileData(TileSlug_GROUND));
 			}
-			if (world_tiles[room->TL_corner.x][y].data != GetTileData(TileSlug_OPENING)) {
-				Update_WorldTile(world_tiles, NewCoord(room->TL_corner.x, y), GetTileData(TileSlug_WALL));
+			if (state->world_tiles[room->TL_corner.x][y].data != GetTileData(TileSlug_OPENING)) {
+				Update_WorldTile(state, NewCoord(room->TL_corner.x, y), GetTileData(TileSlug_WALL));
 			} else {
-				Update_WorldTile(world_tiles, NewCoord(room->TL_corner.x, y), GetTileData(TileSlug_GROUND));
+				Update_WorldTile(state, NewCoord(room->TL_corner.x, y), GetTileData(TileSlug_GROUND));
 			}
 		}
 	}
@@ -972,15 +1922,15 @@ static void Generate_Room(tile_t **world_tiles, const room_t *room) {
 	// Create empty space inside the room.
 	for (int x = room->TL_corner.x + 1; x < room->TR_corner.x; x++) {
 		for (int y = room->TL_corner.y + 1; y < room->BL_corner.y; y++) {
-			Update_WorldTile(world_tiles, NewCoord(x, y), GetTileData(TileSlug_GROUND));
+			Update_WorldTile(state, NewCoord(x, y), GetTileData(TileSlug_GROUND));
 		}
 	}
 }
 
-char Get_TileForegroundSprite(const tile_t *tile) {
+char Get_TileForegroundSprite(const enemy_pool_t *enemy_pool, const tile_t *tile) {
 	// Show enemy occupier's sprite, before an item's, before the tile's sprite itself.
-	if (tile->enemy_occupier != NULL) {
-		return tile->enemy_occupier->data->sprite;
+	if (tile->enemy_occupier != ENEMY_NONE) {
+		return Get_PoolEnemy(enemy_pool, tile->enemy_occupier)->data->sprite;
 	} else if (tile->item_occupier != NULL) {
 		return tile->item_occupier->sprite;
 	} else {
@@ -990,7 +1940,7 @@ char Get_TileForegroundSprite(const tile_t *tile) {
 
 colour_en Get_TileForegroundColour(const tile_t *tile) {
 	// Show enemy occupier's colour, before an item's, before the tile's colour itself.
-	if (tile->enemy_occupier != NULL) {
+	if (tile->enemy_occupier != ENEMY_NONE) {
 		return Clr_RED;
 	} else if (tile->item_occupier != NULL) {
 		return Clr_GREEN;
@@ -1001,7 +1951,7 @@ colour_en Get_TileForegroundColour(const tile_t *tile) {
 
 tile_type_en Get_TileForegroundType(const tile_t *tile) {
 	// Show enemy occupier's type, before an item's, before the tile's type itself.
-	if (tile->enemy_occupier != NULL) {
+	if (tile->enemy_occupier != ENEMY_NONE) {
 		return TileType_ENEMY;
 	} else if (tile->item_occupier != NULL) {
 		return TileType_ITEM;
@@ -1010,75 +1960,366 @@ tile_type_en Get_TileForegroundType(const tile_t *tile) {
 	}
 }
 
-void Update_WorldTile(tile_t **world_tiles, coord_t pos, const tile_data_t *tile_data) {
-	assert(world_tiles != NULL);
+void Update_WorldTile(game_state_t *state, coord_t pos, const tile_data_t *tile_data) {
+	assert(state != NULL);
 	assert(tile_data != NULL);
 
-	world_tiles[pos.x][pos.y].data = tile_data;
+	state->world_tiles[pos.x][pos.y].data = tile_data;
+	Update_SolidMaskTile(state, pos);
+	Update_WorldGlyph(state, pos);
 }
 
-void Update_WorldTileItemOccupier(tile_t **world_tiles, coord_t pos, const item_t *item) {
-	assert(world_tiles != NULL);
+void Update_WorldTileItemOccupier(game_state_t *state, coord_t pos, const item_t *item) {
+	assert(state != NULL);
 
-	world_tiles[pos.x][pos.y].item_occupier = item;
+	state->world_tiles[pos.x][pos.y].item_occupier = item;
+	Set_SpatialHashTile(&state->item_hash, pos, item != NULL);
+	Update_WorldGlyph(state, pos);
 }
 
-void Update_WorldTileEnemyOccupier(tile_t **world_tiles, coord_t pos, enemy_t *enemy) {
-	assert(world_tiles != NULL);
+void Update_WorldTileEnemyOccupier(game_state_t *state, coord_t pos, int enemy_index) {
+	assert(state != NULL);
 
-	world_tiles[pos.x][pos.y].enemy_occupier = enemy;
+	state->world_tiles[pos.x][pos.y].enemy_occupier = enemy_index;
+	Set_SpatialHashTile(&state->enemy_hash, pos, enemy_index != ENEMY_NONE);
+	Update_WorldGlyph(state, pos);
 }
 
-void Apply_Vision(const game_state_t *state, coord_t pos) {
+int Find_EnemiesInRadius(const game_state_t *state, coord_t center, int radius, int *enemy_indices, int max_enemies) {
 	assert(state != NULL);
-	assert(pos.x >= 0 && pos.x < Get_WorldScreenWidth());
-	assert(pos.y >= 0 && pos.y < Get_WorldScreenHeight());
 
-	const tile_t *tile = &state->world_tiles[pos.x][pos.y];
+	// Each tile index found becomes its occupier's index in place.
+	const int num_found = Query_SpatialHashRadius(&state->enemy_hash, center, radius, enemy_indices, max_enemies);
+	for (int i = 0; i < num_found; i++) {
+		enemy_indices[i] = state->world_tiles[enemy_indices[i] / state->enemy_hash.height][enemy_indices[i] % state->enemy_hash.height].enemy_occupier;
+	}
+	return num_found;
+}
+
+int Find_EnemiesInRect(const game_state_t *state, coord_t min, coord_t max, int *enemy_indices, int max_enemies) {
+	assert(state != NULL);
+
+	const int num_found = Query_SpatialHashRect(&state->enemy_hash, min, max, enemy_indices, max_enemies);
+	for (int i = 0; i < num_found; i++) {
+		enemy_indices[i] = state->world_tiles[enemy_indices[i] / state->enemy_hash.height][enemy_indices[i] % state->enemy_hash.height].enemy_occupier;
+	}
+	return num_found;
+}
+
+bool Find_NearestItem(const game_state_t *state, coord_t center, int max_distance, coord_t *item_pos) {
+	assert(state != NULL);
+
+	return Find_SpatialHashNearest(&state->item_hash, center, max_distance, item_pos);
+}
+
+void Update_FieldOfView(game_state_t *state) {
+	assert(state != NULL);
+
+	if (!state->fov_dirty && CoordsEqual(state->fov_origin, state->player.pos) && state->fov_max_vision == state->player.stats.max_vision) {
+		state->debug_fov_usec = 0.0;
+		return;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	Remember_VisibleTiles(state);
+	Compute_FieldOfView(&state->solid_mask, &state->visible_mask, state->player.pos, state->player.stats.max_vision);
+
+	const int reach = (int)ceil(sqrt(state->player.stats.max_vision));
+	Or_BitGridRows(&state->explored_mask, &state->visible_mask, state->player.pos.y - reach, state->player.pos.y + reach);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	state->fov_origin = state->player.pos;
+	state->fov_max_vision = state->player.stats.max_vision;
+	state->fov_dirty = false;
+	state->debug_fov_usec = ((end.tv_sec - start.tv_sec) * 1e6) + ((end.tv_nsec - start.tv_nsec) / 1e3);
+}
+
+void Draw_World(const game_state_t *state) {
+	assert(state != NULL);
+
+	const glyph_layer_t *world = &state->world_glyphs;
+	const glyph_layer_t *remembered = &state->remembered_glyphs;
 
-	if (state->fog_of_war) {
-		const int vision_to_tile = abs((pos.x - state->player.pos.x) * (pos.x - state->player.pos.x)) + abs((pos.y - state->player.pos.y) * (pos.y - state->player.pos.y));
-		if (vision_to_tile < state->player.stats.max_vision) {
-			GEO_draw_char(pos.x, pos.y, Get_TileForegroundColour(tile), Get_TileForegroundSprite(tile));
+	for (int y = 0; y < world->height; y++) {
+		const int row = y * world->width;
+		if (!state->fog_of_war) {
+			GEO_draw_row(0, y, &world->sprites[row], &world->colours[row], world->width);
+			continue;
 		}
-	} else {
-		GEO_draw_char(pos.x, pos.y, Get_TileForegroundColour(tile), Get_TileForegroundSprite(tile));
+
+		// Explored tiles are drawn as remembered, then the visible ones (always explored too) are drawn over them as they are.
+		int run_start, run_end;
+		for (int x = 0; Find_BitGridRun(&state->explored_mask, y, x, &run_start, &run_end); x = run_end) {
+			GEO_draw_row(run_start, y, &remembered->sprites[row + run_start], &remembered->colours[row + run_start], run_end - run_start);
+		}
+		for (int x = 0; Find_BitGridRun(&state->visible_mask, y, x, &run_start, &run_end); x = run_end) {
+			GEO_draw_row(run_start, y, &world->sprites[row + run_start], &world->colours[row + run_start], run_end - run_start);
+		}
+	}
+}
+
+bool Check_EnemyWalkable(const tile_t *tile) {
+	assert(tile != NULL);
+
+	return (tile->data->type == TileType_EMPTY || tile->data->type == TileType_ITEM) && tile->data != GetTileData(TileSlug_VOID);
+}
+
+int Get_EnemyWakeRadius(const player_t *player) {
+	assert(player != NULL);
+
+	// Vision reaches tiles whose squared distance is below 'max_vision'.
+	return (int)ceil(sqrt(player->stats.max_vision)) + ENEMY_WAKE_MARGIN;
+}
+
+void Update_ActiveRegion(game_state_t *state) {
+	assert(state != NULL);
+
+	enemy_pool_t *pool = &state->enemy_pool;
+	const coord_t player_pos = state->player.pos;
+	const int wake_radius = Get_EnemyWakeRadius(&state->player);
+
+	// A cell of slack keeps enemies near the edge from waking and sleeping every other turn. Sleeping swaps in the last awake enemy, so walk backwards.
+	const int sleep_radius = wake_radius + ENEMY_CELL_SIZE;
+	for (int i = pool->num_awake - 1; i >= 0; i--) {
+		const int enemy_index = pool->awake_slots[i];
+		const coord_t pos = Get_PoolEnemy(pool, enemy_index)->pos;
+		if (abs(pos.x - player_pos.x) > sleep_radius || abs(pos.y - player_pos.y) > sleep_radius) {
+			Unschedule_Actor(&state->enemy_scheduler, enemy_index);
+			Sleep_PoolEnemy(pool, enemy_index);
+		}
+	}
+
+	// Woken enemies join the end of the awake set, and react straight away.
+	const int num_awake = pool->num_awake;
+	Wake_EnemyPoolCells(pool, player_pos.x - wake_radius, player_pos.y - wake_radius, player_pos.x + wake_radius, player_pos.y + wake_radius);
+	for (int i = num_awake; i < pool->num_awake; i++) {
+		Schedule_Actor(&state->enemy_scheduler, pool->awake_slots[i], state->game_time);
+	}
+}
+
+void Update_FlowField(game_state_t *state) {
+	assert(state != NULL);
+
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// All bytes set gives FLOW_FIELD_UNREACHED for every tile.
+	memset(state->flow_field, 0xFF, sizeof(*state->flow_field) * world_screen_w * world_screen_h);
+	if (Check_OutOfWorldBounds(state->player.pos)) {
+		return;
+	}
+
+	// Every move costs the same, so a plain breadth-first search visits tiles in order of distance, each exactly once.
+	int queue_start = 0;
+	int queue_end = 0;
+	const int player_index = (state->player.pos.x * world_screen_h) + state->player.pos.y;
+	state->flow_field[player_index] = 0;
+	state->flow_queue[queue_end++] = player_index;
+
+	while (queue_start < queue_end) {
+		const int index = state->flow_queue[queue_start++];
+		const int x = index / world_screen_h;
+		const int y = index % world_screen_h;
+		const int next_distance = state->flow_field[index] + 1;
+
+		const coord_t neighbours[4] = {NewCoord(x, y - 1), NewCoord(x, y + 1), NewCoord(x - 1, y), NewCoord(x + 1, y)};
+		for (int i = 0; i < 4; i++) {
+			if (Check_OutOfWorldBounds(neighbours[i])) {
+				continue;
+			}
+
+			const int neighbour_index = (neighbours[i].x * world_screen_h) + neighbours[i].y;
+			if (state->flow_field[neighbour_index] == FLOW_FIELD_UNREACHED && Check_EnemyWalkable(&state->world_tiles[neighbours[i].x][neighbours[i].y])) {
+				state->flow_field[neighbour_index] = next_distance;
+				state->flow_queue[queue_end++] = neighbour_index;
+			}
+		}
+	}
+}
+
+void Update_EnemyTurns(game_state_t *state) {
+	assert(state != NULL);
+
+	// Only enemies due before the player's next action are taken from the schedule, each in O(log n).
+	const long long turn_end = state->game_time + Get_ActionDelay(state->player.stats.speed);
+	long long action_time;
+	int enemy_index;
+	while ((enemy_index = Pop_DueActor(&state->enemy_scheduler, turn_end, &action_time)) != SCHEDULER_NONE) {
+		// An enemy acting again this turn must see where its last action left it, so the batch so far is carried out first.
+		if (state->enemy_planned[enemy_index]) {
+			Commit_EnemyPlans(state);
+		}
+
+		state->enemy_planned[enemy_index] = true;
+		state->enemy_plans[state->num_enemy_plans++].enemy_index = enemy_index;
+
+		// Acting never kills an enemy, so its next action can be scheduled straight away.
+		Schedule_Actor(&state->enemy_scheduler, enemy_index, action_time + Get_ActionDelay(Get_PoolEnemy(&state->enemy_pool, enemy_index)->data->speed));
+	}
+	Commit_EnemyPlans(state);
+
+	state->game_time = turn_end;
+}
+
+unsigned long long Hash_GameState(const game_state_t *state) {
+	assert(state != NULL);
+
+	// FNV-1a over every value that enemy turns and combat can change.
+	unsigned long long hash = 14695981039346656037ULL;
+#define HASH_VALUE(value) hash = (hash ^ (unsigned long long)(value)) * 1099511628211ULL
+
+	HASH_VALUE(state->game_time);
+	HASH_VALUE(state->rng_state);
+	HASH_VALUE(state->player.pos.x);
+	HASH_VALUE(state->player.pos.y);
+	HASH_VALUE(state->player.stats.curr_health);
+
+	const enemy_pool_t *pool = &state->enemy_pool;
+	HASH_VALUE(pool->num_active);
+	for (int i = 0; i < pool->num_slots; i++) {
+		const enemy_t *enemy = &pool->enemies[i];
+		HASH_VALUE(enemy->is_alive);
+		HASH_VALUE(enemy->pos.x);
+		HASH_VALUE(enemy->pos.y);
+		HASH_VALUE(enemy->curr_health);
 	}
+
+	for (int x = 0; x < Get_WorldScreenWidth(); x++) {
+		for (int y = 0; y < Get_WorldScreenHeight(); y++) {
+			HASH_VALUE(state->world_tiles[x][y].enemy_occupier);
+			HASH_VALUE(state->world_tiles[x][y].item_occupier != NULL ? state->world_tiles[x][y].item_occupier->item_slug : ItmSlug_NONE);
+		}
+	}
+
+#undef HASH_VALUE
+	return hash;
 }
 
-void Update_GameLog(log_list_t *game_log, const char *format, ...) {
-	assert(game_log != NULL);
+static void Plan_EnemyTurns(void *context, int begin, int end) {
+	const game_state_t *state = context;
+	assert(state != NULL);
+
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	for (int i = begin; i < end; i++) {
+		enemy_plan_t *plan = &state->enemy_plans[i];
+		const enemy_t *enemy = Get_PoolEnemy(&state->enemy_pool, plan->enemy_index);
+		plan->num_targets = 0;
 
-	// Cycle old log messages upwards.
-	snprintf(game_log->line5, LOG_BUFFER_SIZE, game_log->line4);
-	snprintf(game_log->line4, LOG_BUFFER_SIZE, game_log->line3);
-	snprintf(game_log->line3, LOG_BUFFER_SIZE, game_log->line2);
-	snprintf(game_log->line2, LOG_BUFFER_SIZE, game_log->line1);
+		// Enemies that can't reach the player stay put.
+		const int distance = state->flow_field[(enemy->pos.x * world_screen_h) + enemy->pos.y];
+		if (distance == FLOW_FIELD_UNREACHED) {
+			continue;
+		}
 
-	// Feed in the new log message to the front of the log list.
-	va_list argp;
-	va_start(argp, format);
-	vsnprintf(game_log->line1, LOG_BUFFER_SIZE, format, argp);
-	va_end(argp);
+		// Any neighbour one step closer leads downhill to the player, and is preferred in direction order. Next to the player, the only such neighbour is the player's tile.
+		const coord_t neighbours[4] = {
+			NewCoord(enemy->pos.x, enemy->pos.y - 1), NewCoord(enemy->pos.x, enemy->pos.y + 1),
+			NewCoord(enemy->pos.x - 1, enemy->pos.y), NewCoord(enemy->pos.x + 1, enemy->pos.y)
+		};
+		for (int n = 0; n < 4; n++) {
+			if (!Check_OutOfWorldBounds(neighbours[n]) && state->flow_field[(neighbours[n].x * world_screen_h) + neighbours[n].y] == distance - 1) {
+				plan->targets[plan->num_targets++] = neighbours[n];
+			}
+		}
+	}
 }
 
-void Update_AllEnemyCombat(game_state_t *state, enemy_node_t *enemy_list) {
+static void Commit_EnemyPlans(game_state_t *state) {
 	assert(state != NULL);
-	assert(enemy_list != NULL);
-
-	enemy_node_t *node = enemy_list;
-	for (; node != NULL; node = node->next) {
-		if (CoordsEqual(node->enemy->pos, state->player.pos)) {
-			state->player.stats.curr_health--;
-			node->enemy->curr_health--;
-			if (node->enemy->curr_health <= 0) {
-				node->enemy->is_alive = false;
-				Update_WorldTileEnemyOccupier(state->world_tiles, node->enemy->pos, NULL);
+
+	if (state->enemy_planners != NULL && state->num_enemy_plans >= ENEMY_PLAN_PARALLEL_MIN) {
+		Run_ThreadPool(state->enemy_planners, Plan_EnemyTurns, state, state->num_enemy_plans);
+	} else {
+		Plan_EnemyTurns(state, 0, state->num_enemy_plans);
+	}
+
+	// Two enemies may have planned the same step, so plans are committed in batch order: the earlier one takes it, and the later one tries its next choice.
+	for (int i = 0; i < state->num_enemy_plans; i++) {
+		const enemy_plan_t *plan = &state->enemy_plans[i];
+		enemy_t *enemy = Get_PoolEnemy(&state->enemy_pool, plan->enemy_index);
+
+		for (int t = 0; t < plan->num_targets; t++) {
+			// A step onto the player's tile is an attack instead, so an enemy only hits the player with an action of its own.
+			if (CoordsEqual(plan->targets[t], state->player.pos)) {
+				state->player.stats.curr_health--;
+				Log_GameEvent(&state->game_log, LogEvent_ENEMY_DMG_PLR, enemy->data->name, 1);
+				break;
 			}
+			if (state->world_tiles[plan->targets[t].x][plan->targets[t].y].enemy_occupier == ENEMY_NONE) {
+				Update_WorldTileEnemyOccupier(state, enemy->pos, ENEMY_NONE);
+				Update_WorldTileEnemyOccupier(state, plan->targets[t], plan->enemy_index);
+				enemy->pos = plan->targets[t];
+				break;
+			}
+		}
+		state->enemy_planned[plan->enemy_index] = false;
+	}
+	state->num_enemy_plans = 0;
+}
+
+int Find_Path(game_state_t *state, coord_t from, coord_t to) {
+	assert(state != NULL);
+
+	pathfinder_t *pathfinder = &state->pathfinder;
+	Begin_PathfinderQuery(pathfinder);
+	if (Check_OutOfWorldBounds(from) || Check_OutOfWorldBounds(to)) {
+		return PATH_NOT_FOUND;
+	}
+
+	const int world_screen_h = Get_WorldScreenHeight();
+	const int from_index = (from.x * world_screen_h) + from.y;
+	const int to_index = (to.x * world_screen_h) + to.y;
+
+	// Every step costs 1 in one of four directions, so the Manhattan distance never overestimates (and A* never reopens a node).
+	const int start_heuristic = abs(to.x - from.x) + abs(to.y - from.y);
+	Get_PathNode(pathfinder, from_index)->cost = 0;
+	Push_PathHeap(pathfinder, from_index, start_heuristic, start_heuristic);
+
+	while (pathfinder->heap_size > 0) {
+		const int index = Pop_PathHeap(pathfinder);
+		if (index == to_index) {
 			break;
 		}
+
+		const int x = index / world_screen_h;
+		const int y = index % world_screen_h;
+		const int next_cost = pathfinder->nodes[index].cost + 1;
+
+		const coord_t neighbours[4] = {NewCoord(x, y - 1), NewCoord(x, y + 1), NewCoord(x - 1, y), NewCoord(x + 1, y)};
+		for (int i = 0; i < 4; i++) {
+			if (Check_OutOfWorldBounds(neighbours[i]) || !Check_EnemyWalkable(&state->world_tiles[neighbours[i].x][neighbours[i].y])) {
+				continue;
+			}
+
+			const int neighbour_index = (neighbours[i].x * world_screen_h) + neighbours[i].y;
+			path_node_t *neighbour = Get_PathNode(pathfinder, neighbour_index);
+			if (neighbour->heap_position == PATH_NODE_CLOSED || next_cost >= neighbour->cost) {
+				continue;
+			}
+
+			neighbour->cost = next_cost;
+			neighbour->parent = index;
+			const int heuristic = abs(to.x - neighbours[i].x) + abs(to.y - neighbours[i].y);
+			Push_PathHeap(pathfinder, neighbour_index, next_cost + heuristic, heuristic);
+		}
+	}
+
+	if (Get_PathNode(pathfinder, to_index)->heap_position != PATH_NODE_CLOSED) {
+		return PATH_NOT_FOUND;
 	}
+
+	// Walk the parents back from the goal, filling the path from its end.
+	pathfinder->path_length = pathfinder->nodes[to_index].cost;
+	int index = to_index;
+	for (int step = pathfinder->path_length - 1; step >= 0; step--) {
+		pathfinder->path[step] = NewCoord(index / world_screen_h, index % world_screen_h);
+		index = pathfinder->nodes[index].parent;
+	}
+	return pathfinder->path_length;
 }
+
 void Interact_CurrentlySelectedItem(game_state_t *state, item_select_control_en key_pressed) {
 	assert(state != NULL);
 
@@ -1093,9 +2334,9 @@ void Interact_CurrentlySelectedItem(game_state_t *state, item_select_control_en
 					int health_restored = AddTo_Health(&state->player, health_to_add);
 
 					if (health_restored > 0) {
-						Update_GameLog(&state->game_log, LOGMSG_PLR_USE_FOOD, health_restored);
+						Log_GameEvent(&state->game_log, LogEvent_PLR_USE_FOOD, health_restored);
 					} else {
-						Update_GameLog(&state->game_log, LOGMSG_PLR_USE_FOOD_FULL);
+						Log_GameEvent(&state->game_log, LogEvent_PLR_USE_FOOD_FULL);
 					}
 
 					state->player.inventory[state->player.current_item_index_selected] = GetItem(ItmSlug_NONE);
@@ -1109,11 +2350,11 @@ void Interact_CurrentlySelectedItem(game_state_t *state, item_select_control_en
 			break;
 		case ItmCtrl_DROP:
 			if (state->world_tiles[state->player.pos.x][state->player.pos.y].item_occupier == NULL) {
-				Update_WorldTileItemOccupier(state->world_tiles, state->player.pos, item_selected);
-				Update_GameLog(&state->game_log, LOGMSG_PLR_DROP_ITEM, item_selected->name);
+				Update_WorldTileItemOccupier(state, state->player.pos, item_selected);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_DROP_ITEM, item_selected->name);
 				state->player.inventory[state->player.current_item_index_selected] = GetItem(ItmSlug_NONE);
 			} else {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_CANT_DROP_ITEM, item_selected->name);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_CANT_DROP_ITEM);
 			}
 			break;
 		default:
@@ -1124,10 +2365,10 @@ void Interact_CurrentlySelectedItem(game_state_t *state, item_select_control_en
 void Examine_Item(game_state_t *state, const item_t *item) {
 	switch (item->item_slug) {
 		case ItmSlug_SMALLFOOD:
-			Update_GameLog(&state->game_log, LOGMSG_EXAMINE_SMALL_FOOD);
+			Log_GameEvent(&state->game_log, LogEvent_EXAMINE_SMALL_FOOD);
 			break;
 		case ItmSlug_BIGFOOD:
-			Update_GameLog(&state->game_log, LOGMSG_EXAMINE_BIG_FOOD);
+			Log_GameEvent(&state->game_log, LogEvent_EXAMINE_BIG_FOOD);
 			break;
 		default:
 			Update_GameLog(&state->game_log, "There's nothing here...?");	// SHOULD NOT HAPPEN
@@ -1157,13 +2398,53 @@ void Draw_HelpScreen(game_state_t *state) {
 	GEO_drawf_align_center(0, terminal_h / 2 - 2, Clr_WHITE, "up/down/left/right: movement keys");
 	GEO_drawf(terminal_w / 2 - 11, terminal_h / 2 - 1, Clr_WHITE, "h: show this help screen");
 	GEO_drawf(terminal_w / 2 - 11, terminal_h / 2 + 0, Clr_WHITE, "f: toggle fog of war");
-	GEO_drawf(terminal_w / 2 - 11, terminal_h / 2 + 1, Clr_WHITE, "q: quit game");
-	GEO_drawf_align_center(0, terminal_h / 2 + 3, Clr_WHITE, "Press any key to continue...");
+	GEO_drawf(terminal_w / 2 - 11, terminal_h / 2 + 1, Clr_WHITE, "l: show message log");
+	GEO_drawf(terminal_w / 2 - 11, terminal_h / 2 + 2, Clr_WHITE, "q: quit game");
+	GEO_drawf_align_center(0, terminal_h / 2 + 4, Clr_WHITE, "Press any key to continue...");
 
 	GEO_show_screen();
 	Get_KeyInput(state);
 }
 
+void Draw_LogScreen(game_state_t *state) {
+	assert(state != NULL);
+
+	const int terminal_h = GEO_screen_height();
+	const int page_lines = terminal_h - 4;
+	const int max_scroll = CLAMP(state->game_log.num_lines - page_lines, 0, LOG_CAPACITY);
+
+	// How many messages older than the newest the bottom line of the page is.
+	int scroll = 0;
+	while (!g_process_over) {
+		GEO_clear_screen();
+
+		const int oldest_shown = MIN(scroll + page_lines, state->game_log.num_lines);
+		GEO_drawf_align_center(0, 0, Clr_CYAN, "Message log (%d to %d of %d messages back)", scroll + 1, oldest_shown, state->game_log.num_lines);
+		for (int row = 0; row < page_lines && scroll + row < state->game_log.num_lines; row++) {
+			GEO_drawf(0, terminal_h - 3 - row, Clr_WHITE, "* %s", Get_GameLogLine(&state->game_log, scroll + row));
+		}
+		GEO_drawf_align_center(0, terminal_h - 1, Clr_WHITE, "up/down: scroll, page up/page down: turn page, any other key: continue");
+
+		GEO_show_screen();
+		switch (Get_KeyInput(state)) {
+			case KEY_UP:
+				scroll = CLAMP(scroll + 1, 0, max_scroll);
+				break;
+			case KEY_DOWN:
+				scroll = CLAMP(scroll - 1, 0, max_scroll);
+				break;
+			case KEY_PPAGE:
+				scroll = CLAMP(scroll + page_lines, 0, max_scroll);
+				break;
+			case KEY_NPAGE:
+				scroll = CLAMP(scroll - page_lines, 0, max_scroll);
+				break;
+			default:
+				return;
+		}
+	}
+}
+
 static int Get_KeyInput(game_state_t *state) {
 	// USED TO INJECT INPUT FOR TESTING/DEBUGGING.
 	if (state->debug_injected_inputs[state->debug_injected_input_pos] != '\0') {
@@ -1253,12 +2534,12 @@ void Draw_MerchantScreen(game_state_t *state) {
 		if (state->player.stats.num_gold >= GetItem(chosen_item)->value) {
 			if (AddTo_Inventory(&state->player, GetItem(chosen_item))) {
 				state->player.stats.num_gold -= GetItem(chosen_item)->value;
-				Update_GameLog(&state->game_log, LOGMSG_PLR_BUY_MERCHANT, GetItem(chosen_item)->name);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_BUY_MERCHANT, GetItem(chosen_item)->name);
 			} else {
-				Update_GameLog(&state->game_log, LOGMSG_PLR_BUY_FULL_MERCHANT);
+				Log_GameEvent(&state->game_log, LogEvent_PLR_BUY_FULL_MERCHANT);
 			}
 		} else {
-			Update_GameLog(&state->game_log, LOGMSG_PLR_INSUFFICIENT_GOLD_MERCHANT);
+			Log_GameEvent(&state->game_log, LogEvent_PLR_INSUFFICIENT_GOLD_MERCHANT);
 		}
 	}
 }
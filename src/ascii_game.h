@@ -7,30 +7,58 @@
 #include "coord.h"
 #include "tiles.h"
 #include "colours.h"
+#include "bitgrid.h"
+#include "glyph_layer.h"
+#include "game_log.h"
+#include "arena.h"
+#include "pathfinder.h"
+#include "scheduler.h"
+#include "thread_pool.h"
+#include "spatial_hash.h"
 
 
 #define CLAMP(x, min_val, max_val) (((x) < (min_val)) ? (min_val) : (((x) > (max_val)) ? (max_val) : (x)))
+#define MIN(x, y) (((x) < (y)) ? (x) : (y))
 
 // Sprites.
 #define SPR_EMPTY ' '
 #define SPR_PLAYER '@'
 
 // Other.
-#define HUB_FILENAME "maps/hub.txt"
+#define HUB_FILENAME "maps/hub.map"				// Compiled from HUB_SOURCE_FILENAME by the mapc tool.
+#define HUB_SOURCE_FILENAME "maps/hub.txt"
 #define HUB_MAP_FREQUENCY 4
+#define CAVE_MAP_FREQUENCY 3
 #define PLAYER_MAX_VISION 100
+#define PLAYER_SPEED 100
 #define RIGHT_PANEL_OFFSET 36
 #define BOTTOM_PANEL_OFFSET 6			
 #define TOP_PANEL_OFFSET 0		
 #define DEBUG_RCS_LIMIT 100000			// Room collision limit.
 #define DEBUG_INJECTED_INPUT_LIMIT 256	// Injected user input limit (used for testing).
-#define LOG_BUFFER_SIZE 175
 #define MIN_ROOMS 2
 #define MAX_ROOMS 100
 #define MIN_ROOM_SIZE 5
 #define INVENTORY_SIZE 9
+#define FLOOR_GENERATION_ATTEMPTS 5		// Attempts at generating a floor with a reachable staircase before an unreachable one is accepted.
 #define _UNITY_VOID_SPRITE ';'		// Used by the Unity img-to-ascii converter for representing the void. NOTE: This value must be unique - no other sprite may use it.
 
+// Compiled binary maps.
+#define MAP_BINARY_MAGIC "AMAP"
+#define MAP_BINARY_MAGIC_SIZE 4
+#define MAP_BINARY_VERSION 1
+#define MAP_BINARY_NO_ITEM 0xFF			// Item slug stored for tiles without an item.
+
+// Cave generation.
+#define CAVE_INITIAL_WALL_CHANCE 45		// Percentage chance for each cell to start as a wall.
+#define CAVE_AUTOMATON_STEPS 5
+#define CAVE_BIRTH_LIMIT 5				// Open cells with at least this many wall neighbours become walls.
+#define CAVE_SURVIVAL_LIMIT 4			// Walls with at least this many wall neighbours stay walls.
+
+#define FLOW_FIELD_UNREACHED (-1)		// Flow field distance of tiles that enemies can't reach the player from.
+#define ENEMY_WAKE_MARGIN 4				// Tiles beyond the edge of the player's vision within which sleeping enemies wake.
+#define ENEMY_PLAN_PARALLEL_MIN 128		// Batches of fewer enemy actions are planned on the calling thread, as waking the planner threads would cost more.
+
 typedef enum direction_en {
 	Dir_UP,
 	Dir_DOWN,
@@ -38,6 +66,12 @@ typedef enum direction_en {
 	Dir_RIGHT
 } direction_en;
 
+typedef enum floor_layout_en {
+	FloorLayout_ROOMS,		// Rooms grown recursively from the world center, retrying on collisions.
+	FloorLayout_BSP,		// Rooms placed in a binary space partition of the world, always creating the number of rooms specified.
+	FloorLayout_CAVE
+} floor_layout_en;
+
 typedef enum item_select_control_en {
 	ItmCtrl_USE = 'e',
 	ItmCtrl_DROP = 'd',
@@ -52,6 +86,7 @@ typedef struct player_stats {
 	int curr_mana;
 
 	int max_vision;
+	int speed;			// Sets the length of a game turn, in which enemies act according to their own speed.
 
 	int s_str;	
 	int s_def;
@@ -63,14 +98,6 @@ typedef struct player_stats {
 	int num_gold;
 } stats_t;
 
-typedef struct log_list_t {
-	char line1[LOG_BUFFER_SIZE];	// First message that is shown in the game log.
-	char line2[LOG_BUFFER_SIZE];	// Second message that is shown in the game log.
-	char line3[LOG_BUFFER_SIZE];	// Third message that is shown in the game log.
-	char line4[LOG_BUFFER_SIZE];	// Fourth message that is shown in the game log.
-	char line5[LOG_BUFFER_SIZE];	// Final message that is shown in the game log.
-} log_list_t;
-
 typedef struct room_t {
 	coord_t TL_corner;
 	coord_t TR_corner;
@@ -78,6 +105,40 @@ typedef struct room_t {
 	coord_t BR_corner;
 } room_t;
 
+typedef struct floor_connectivity_t {
+	int reachable_area;					// Number of walkable world tiles reachable from the player's position.
+	int staircase_distance;				// Steps needed to reach the staircase from the player's position, or -1 if it can't be reached.
+} floor_connectivity_t;
+
+typedef enum map_spawn_en {
+	MapSpawn_PLAYER,
+	MapSpawn_STAIRCASE,
+	MapSpawn_ENEMY
+} map_spawn_en;
+
+typedef struct map_reader_t {
+	const unsigned char *data;
+	size_t size;
+	size_t pos;
+	bool failed;						// Set once a read runs past the end of the data.
+} map_reader_t;
+
+typedef struct enemy_spawn_t {
+	const enemy_data_t *data;
+	coord_t pos;						// Position relative to the map template's top-left corner.
+} enemy_spawn_t;
+
+typedef struct map_template_t {
+	int width;
+	int height;
+	coord_t anchor;						// Offset of the template's top-left corner from the center of the world.
+	tile_t *tiles;						// Pre-decoded tiles (without enemies) in column-major order, so each column is copied into the world in one go.
+	enemy_spawn_t *enemy_spawns;		// Enemies to create whenever the template is stamped.
+	int num_enemy_spawns;
+	coord_t player_spawn;				// Relative to the template's top-left corner, or (-1, -1) if it has none.
+	coord_t staircase_pos;				// Relative to the template's top-left corner, or (-1, -1) if it has none.
+} map_template_t;
+
 typedef struct player_t {
 	stats_t stats;
 	coord_t pos;
@@ -88,22 +149,60 @@ typedef struct player_t {
 	int current_item_index_selected;				// The currently selected item index from the player's inventory, used to interact with the item.
 } player_t;
 
+typedef struct enemy_plan_t {
+	int enemy_index;
+	int num_targets;
+	coord_t targets[4];					// Tiles the enemy would step to, best first. The first one free when the plan is committed is taken.
+} enemy_plan_t;
+
 typedef struct game_state_t {
 	int game_turns;						// Current number of game turns since game started.
 	int num_rooms_created;				// Number of rooms created in game (may not always == num_rooms_specified in command line).
 	bool fog_of_war;					// Toggle whether all world tiles are shown or only those within range of the player.
 	bool player_turn_over;				// Determines when the player has finished their turn.
 	bool floor_complete;				// Determines when the player has completed the dungeon floor.
+	bool regenerate_unreachable_floors;	// Toggle whether generated floors with an unreachable staircase are thrown away and generated again.
 	int current_floor;			
 
 	player_t player;				
 	tile_t **world_tiles;				// Stores information about every (x, y) coordinate in the world map, for use in the game.
 	room_t *rooms;						// Array of all created rooms after dungeon generation.
 	log_list_t game_log;			
-	enemy_node_t *enemy_list;			// Linked list of all enemies created in a dungeon.
+	arena_t floor_arena;				// Every allocation that lives as long as a dungeon floor, released at once when the floor is cleaned up.
+	enemy_pool_t enemy_pool;			// Every enemy created in a dungeon, referred to by index from world tiles.
+	pathfinder_t pathfinder;			// Node storage and open set reused by every 'Find_Path' query on the floor.
+	spatial_hash_t enemy_hash;			// Tiles with an enemy occupier, bucketed by area. Kept current by 'Update_WorldTileEnemyOccupier'.
+	spatial_hash_t item_hash;			// Tiles with an item occupier, bucketed by area. Kept current by 'Update_WorldTileItemOccupier'.
+	scheduler_t enemy_scheduler;		// When each awake enemy acts next. Sleeping enemies aren't scheduled.
+	long long game_time;				// Scheduler time at which the player's next action takes place.
+	enemy_plan_t *enemy_plans;			// Batch of enemy actions planned together, in the order they are committed.
+	bool *enemy_planned;				// Whether each enemy slot already has an action in the current batch.
+	int num_enemy_plans;
+	thread_pool_t *enemy_planners;		// Threads that plan enemy actions in parallel (NULL to plan on the calling thread).
+	coord_t staircase_pos;				// Position of the dungeon floor's staircase, or (-1, -1) if it has none.
+	const struct prefab_library_t *prefab_library;	// Prefab rooms that room generation may stamp instead of plain rooms (NULL for none).
+	floor_connectivity_t connectivity;	// Connectivity of the current dungeon floor, validated when it is created.
+
+	bitgrid_t walkable_mask;			// Packed non-solid world tiles, used to validate connectivity.
+	bitgrid_t reachable_mask;			// Packed world tiles reached by the connectivity flood fill.
+	bitgrid_t frontier_mask;			// Packed breadth-first layer of the connectivity flood fill.
+	bitgrid_t scratch_mask;				// Packed scratch space for the connectivity flood fill.
+	bitgrid_t solid_mask;				// Packed solid world tiles, which block sight. Kept current by 'Update_WorldTile'.
+	bitgrid_t visible_mask;				// Packed world tiles the player can see, as of the last call to 'Update_FieldOfView'.
+	coord_t fov_origin;					// Player position and vision the visible tiles were last computed for.
+	int fov_max_vision;
+	bool fov_dirty;						// Set when a visible tile starts or stops blocking sight, so the visible tiles must be computed again.
+	bitgrid_t explored_mask;			// Packed world tiles the player has seen on this floor.
+	glyph_layer_t world_glyphs;			// How each world tile looks (sprite and colour), kept current by the 'Update_WorldTile*' setters so drawing never works it out.
+	glyph_layer_t remembered_glyphs;	// How each explored tile looked (without enemies) when the player last saw it, already dimmed.
+
+	int *flow_field;					// Steps from each world tile (index x * world height + y) to the player, walking only where enemies can. Recomputed every turn.
+	int *flow_queue;					// Breadth-first queue of tile indices used to compute the flow field.
 
 	int debug_rcs;						// Room collisions during room creation.
+	double debug_fov_usec;				// Microseconds spent computing the visible tiles for the last drawn turn (0 if they were reused).
 	double debug_seed;					// RNG seed used to create this game.
+	unsigned int rng_state;				// State of this game's own random number generator, so separate games (e.g. on separate threads) never share one.
 
 	// This debug field is used to simulate a sequence of player inputs and inject them into unit tests. +1 to ensure a NUL-terminating byte.
 	int debug_injected_inputs[DEBUG_INJECTED_INPUT_LIMIT + 1];
@@ -120,11 +219,39 @@ extern bool g_process_over;
 */
 void Init_GameState(game_state_t *state);
 
+/*
+	Seeds the game's random number generator. Every dungeon floor created afterwards is determined by 'seed'.
+*/
+void Seed_GameState(game_state_t *state, unsigned int seed);
+
 /* 
 	Initialises and creates a dungeon floor which consists of, at least, a player spawn room and a staircase room, with rooms connected inbetween filled with enemies and items. 
-	Optionally specify a text file to use a custom layout for the dungeon floor.
+	The floor is generated with the specified 'layout', unless a map template is specified to use a custom layout for the dungeon floor.
 */
-void InitCreate_DungeonFloor(game_state_t *state, unsigned int num_rooms_specified, const char *filename_specified);
+void InitCreate_DungeonFloor(game_state_t *state, unsigned int num_rooms_specified, floor_layout_en layout, const map_template_t *map_template);
+
+/*
+	Parses the map file named 'filename' (either a txt map or a compiled binary map) once into a map template, which can then be stamped into any number of dungeon floors without touching the file again.
+	Returns false if the file could not be opened, or is an invalid compiled map.
+*/
+bool Init_MapTemplate(map_template_t *map_template, const char *filename);
+
+/*
+	Frees all memory allocated from calling 'Init_MapTemplate'.
+*/
+void Cleanup_MapTemplate(map_template_t *map_template);
+
+/*
+	Writes a map template to 'filename' in the compiled binary map format: a header (magic, version, dimensions, anchor, number of spawns),
+	one row of run-length encoded (tile slug, item slug) pairs per line, then a table of player, staircase and enemy spawns. All values are little-endian.
+	Returns false if the file could not be written.
+*/
+bool Save_MapTemplate(const map_template_t *map_template, const char *filename);
+
+/*
+	Flood fills the walkable world tiles from the player's position, 64 tiles at a time, and returns how much of the floor is reachable and how far away the staircase is.
+*/
+floor_connectivity_t Validate_FloorConnectivity(game_state_t *state);
 
 /*
 	Initialises a player struct to it's default values and returns it.
@@ -132,9 +259,19 @@ void InitCreate_DungeonFloor(game_state_t *state, unsigned int num_rooms_specifi
 player_t Create_Player(void);
 
 /*
-	Initalises and creates an enemy with it's default values set according to the enemy_data struct. It's current position is set to 'pos'. The created enemy is returned.
+	Initialises an enemy with it's default values set according to the enemy_data struct and returns it. It's current position is set to 'pos'.
 */
-enemy_t* InitCreate_Enemy(const enemy_data_t *enemy_data, coord_t pos);
+enemy_t Create_Enemy(const enemy_data_t *enemy_data, coord_t pos);
+
+/*
+	Creates an enemy at 'pos' in the dungeon floor's enemy pool and places it on the world tile there. Returns the enemy's index.
+*/
+int Spawn_Enemy(game_state_t *state, const enemy_data_t *enemy_data, coord_t pos);
+
+/*
+	Removes a dead enemy from the dungeon floor and its enemy pool, dropping its loot (if any) where it died. Its index may be reused by the next enemy spawned.
+*/
+void Kill_Enemy(game_state_t *state, int enemy_index);
 
 /*
 	Draws all elements to the screen, waits for user input, then performs world logic in response. Returning from this essentially finishes one game turn.
@@ -146,6 +283,11 @@ void Process(game_state_t *state);
 */
 void Draw_HelpScreen(game_state_t *state);
 
+/*
+	Draws the game log's history a page at a time, newest at the bottom. Up/down scroll by a message and page up/page down by a page; any other key returns.
+*/
+void Draw_LogScreen(game_state_t *state);
+
 /*
 	Draws the player death screen. Waits for user input before returning.
 */
@@ -157,34 +299,82 @@ void Draw_DeathScreen(game_state_t *state);
 void Draw_MerchantScreen(game_state_t *state);
 
 /*
-	Updates a world tile at position 'pos' with a new set of tile data.
+	Updates a world tile at position 'pos' with a new set of tile data, keeping the solid tile mask current.
+	If a visible tile starts or stops blocking sight, the player's field of view is marked to be computed again.
+*/
+void Update_WorldTile(game_state_t *state, coord_t pos, const tile_data_t *tile_data);
+
+/*
+	Updates a world tile at position 'pos' with a new item occupier (NULL for no item), keeping the item spatial hash current.
+*/
+void Update_WorldTileItemOccupier(game_state_t *state, coord_t pos, const item_t *item);
+
+/*
+	Updates a world tile at position 'pos' with a new enemy occupier, by its index in the enemy pool (ENEMY_NONE for no enemy), keeping the enemy spatial hash current.
 */
-void Update_WorldTile(tile_t **world_tiles, coord_t pos, const tile_data_t *tile_data);
+void Update_WorldTileEnemyOccupier(game_state_t *state, coord_t pos, int enemy_index);
 
 /*
-	Updates a world tile at position 'pos' with a new item occupier.
+	Stores the indices of up to 'max_enemies' enemies within 'radius' tiles (by straight-line distance) of 'center' in 'enemy_indices', and returns how many were stored.
+	Only the enemy spatial hash cells around 'center' are visited.
 */
-void Update_WorldTileItemOccupier(tile_t **world_tiles, coord_t pos, const item_t *item);
+int Find_EnemiesInRadius(const game_state_t *state, coord_t center, int radius, int *enemy_indices, int max_enemies);
 
 /*
-	Updates a world tile at position 'pos' with a new enemy occupier.
+	Stores the indices of up to 'max_enemies' enemies from 'min' to 'max' (inclusive) in 'enemy_indices', and returns how many were stored.
 */
-void Update_WorldTileEnemyOccupier(tile_t **world_tiles, coord_t pos, enemy_t *enemy);
+int Find_EnemiesInRect(const game_state_t *state, coord_t min, coord_t max, int *enemy_indices, int max_enemies);
 
 /*
-	Updates the game log consisting of 3 lines with a new formatted line of text, pushing the previous two lines of text upwards. The last line of text is removed.
+	Finds the item on the ground fewest steps from 'center', no more than 'max_distance' steps away (ignoring walls). Returns false if there is none.
 */
-void Update_GameLog(log_list_t *game_log, const char *format, ...);
+bool Find_NearestItem(const game_state_t *state, coord_t center, int max_distance, coord_t *item_pos);
 
 /*
-	Loops through all enemies on the dungeon floor and computes their logic for the current game turn.
+	Returns the distance (in tiles along either axis) from the player within which sleeping enemies wake: the player's vision radius plus ENEMY_WAKE_MARGIN.
 */
-void Update_AllEnemyCombat(game_state_t *state, enemy_node_t *enemy_list);
+int Get_EnemyWakeRadius(const player_t *player);
+
+/*
+	Wakes the enemies in every cell within the wake radius of the player (scheduling them to act at once), and puts awake enemies that have fallen a cell beyond it back to sleep.
+	Costs one step per nearby cell plus one per awake enemy, however many enemies sleep elsewhere on the floor.
+*/
+void Update_ActiveRegion(game_state_t *state);
+
+/*
+	Recomputes the flow field with one breadth-first search outwards from the player, over every tile an enemy can walk on.
+*/
+void Update_FlowField(game_state_t *state);
+
+/*
+	Advances the game time by the player's action delay, letting every enemy due before the player's next action act (as often as its speed allows), in time order.
+	Each enemy's action moves it one step downhill in the flow field, towards the player, or hits the player (for 1 damage) if it is already next to the player.
+	Enemies blocked by other enemies, or unable to reach the player, stay put. The player's own attacks happen when bumping into an enemy.
+	Actions are planned in batches (across 'enemy_planners', without changing the world), then committed one at a time in time and enemy index order,
+	so the outcome never depends on the number of threads.
+*/
+void Update_EnemyTurns(game_state_t *state);
+
+/*
+	Returns a hash of the player, every enemy, the world's occupiers and the game's clock and RNG, for checking that two runs reached exactly the same state.
+*/
+unsigned long long Hash_GameState(const game_state_t *state);
+
+/*
+	Returns true if an enemy could stand on the tile (ignoring any occupiers).
+*/
+bool Check_EnemyWalkable(const tile_t *tile);
+
+/*
+	Finds a shortest path from 'from' to 'to' with A*, moving in the four directions over tiles an enemy could stand on (occupiers are ignored).
+	Returns the number of steps, which are left in 'state->pathfinder.path' (excluding 'from', ending with 'to'), or PATH_NOT_FOUND.
+*/
+int Find_Path(game_state_t *state, coord_t from, coord_t to);
 
 /*
 	Gets the sprite that should be shown to the player when multiple things are at the same position. Foreground sprite is based on ordering rules.
 */
-char Get_TileForegroundSprite(const tile_t *tile);
+char Get_TileForegroundSprite(const enemy_pool_t *enemy_pool, const tile_t *tile);
 
 /*
 	Gets the colour that should be shown to the player when multiple things are at the same position. Foreground colour is based on ordering rules.
@@ -197,10 +387,17 @@ colour_en Get_TileForegroundColour(const tile_t *tile);
 tile_type_en Get_TileForegroundType(const tile_t *tile);
 
 /*
-	Loops through all world tiles on the dungeon floor and determines which should be shown to the user. 
-	Game state variable 'fog_of_war' and player variable 'max_vision' are the determining factors.
+	Computes which world tiles the player can see by shadowcasting from their position over the solid tile mask, out to their 'max_vision' (a squared distance).
+	The visible tiles are reused until the player moves, their vision changes, or a visible tile starts or stops blocking sight.
+	Tiles going out of view are remembered as they were last seen, and the tiles coming into view are added to the explored tiles, only visiting the rows in sight.
+*/
+void Update_FieldOfView(game_state_t *state);
+
+/*
+	Draws the world tiles that should be shown to the user, copying each row of glyphs to the screen in runs: with 'fog_of_war', only tiles the player could see
+	at the last 'Update_FieldOfView' are drawn, and explored tiles out of view are drawn dimmed, as they were remembered.
 */
-void Apply_Vision(const game_state_t *state, coord_t pos);
+void Draw_World(const game_state_t *state);
 
 /*
 	Interacts with the player's currently targeted NPC.
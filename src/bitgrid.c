@@ -0,0 +1,360 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "bitgrid.h"
+
+/*
+	Returns a mask of the bits in a row's final word that lie inside the grid.
+*/
+static uint64_t Get_LastWordMask(const bitgrid_t *grid) {
+	const int used_bits = grid->width - ((grid->words_per_row - 1) * BITGRID_WORD_BITS);
+	return (used_bits == BITGRID_WORD_BITS) ? ~(uint64_t)0 : (((uint64_t)1 << used_bits) - 1);
+}
+
+/*
+	Returns word 'w' of row 'y', where every bit outside the grid (including padding) takes the value of 'outside'.
+*/
+static uint64_t Get_PaddedWord(const bitgrid_t *grid, int y, int w, uint64_t outside) {
+	if (y < 0 || y >= grid->height || w < 0 || w >= grid->words_per_row) {
+		return outside;
+	}
+
+	uint64_t word = grid->words[(y * grid->words_per_row) + w];
+	if (w == grid->words_per_row - 1) {
+		word |= (outside & ~Get_LastWordMask(grid));
+	}
+	return word;
+}
+
+/*
+	Adds a 1-bit value to 64 packed 4-bit counters, stored as bit-planes in 'sum' (least significant plane first).
+*/
+static void Add_ToBitSlicedCount(uint64_t sum[4], uint64_t value) {
+	uint64_t carry = value;
+	for (int plane = 0; plane < 4; plane++) {
+		const uint64_t next_carry = sum[plane] & carry;
+		sum[plane] ^= carry;
+		carry = next_carry;
+	}
+}
+
+/*
+	Returns a mask of the counters in 'sum' that are greater than or equal to 'limit' (counters never exceed 8).
+*/
+static uint64_t Get_CountAtLeastMask(const uint64_t sum[4], int limit) {
+	uint64_t result = 0;
+	for (int count = (limit < 0 ? 0 : limit); count <= 8; count++) {
+		uint64_t equal = ~(uint64_t)0;
+		for (int plane = 0; plane < 4; plane++) {
+			equal &= ((count >> plane) & 1) ? sum[plane] : ~sum[plane];
+		}
+		result |= equal;
+	}
+	return result;
+}
+
+void Init_BitGrid(bitgrid_t *grid, int width, int height) {
+	assert(grid != NULL);
+	assert(width > 0);
+	assert(height > 0);
+
+	grid->width = width;
+	grid->height = height;
+	grid->words_per_row = (width + BITGRID_WORD_BITS - 1) / BITGRID_WORD_BITS;
+	grid->words = calloc((size_t)grid->words_per_row * height, sizeof(*grid->words));
+	assert(grid->words != NULL);
+}
+
+void Init_BitGridInArena(bitgrid_t *grid, arena_t *arena, int width, int height) {
+	assert(grid != NULL);
+	assert(arena != NULL);
+	assert(width > 0);
+	assert(height > 0);
+
+	grid->width = width;
+	grid->height = height;
+	grid->words_per_row = (width + BITGRID_WORD_BITS - 1) / BITGRID_WORD_BITS;
+	grid->words = Alloc_Arena(arena, sizeof(*grid->words) * grid->words_per_row * height);
+	memset(grid->words, 0, sizeof(*grid->words) * grid->words_per_row * height);
+}
+
+size_t Get_BitGridSize(int width, int height) {
+	const int words_per_row = (width + BITGRID_WORD_BITS - 1) / BITGRID_WORD_BITS;
+	return Get_ArenaAllocSize(sizeof(uint64_t) * words_per_row * height);
+}
+
+void Cleanup_BitGrid(bitgrid_t *grid) {
+	assert(grid != NULL);
+
+	free(grid->words);
+	grid->words = NULL;
+}
+
+void Clear_BitGrid(bitgrid_t *grid) {
+	assert(grid != NULL);
+
+	memset(grid->words, 0, sizeof(*grid->words) * grid->words_per_row * grid->height);
+}
+
+bool Get_BitGridCell(const bitgrid_t *grid, int x, int y) {
+	assert(grid != NULL);
+
+	if (x < 0 || x >= grid->width || y < 0 || y >= grid->height) {
+		return false;
+	}
+	return (grid->words[(y * grid->words_per_row) + (x / BITGRID_WORD_BITS)] >> (x % BITGRID_WORD_BITS)) & 1;
+}
+
+void Set_BitGridCell(bitgrid_t *grid, int x, int y, bool value) {
+	assert(grid != NULL);
+	assert(x >= 0 && x < grid->width);
+	assert(y >= 0 && y < grid->height);
+
+	uint64_t *word = &grid->words[(y * grid->words_per_row) + (x / BITGRID_WORD_BITS)];
+	const uint64_t bit = (uint64_t)1 << (x % BITGRID_WORD_BITS);
+
+	if (value) {
+		*word |= bit;
+	} else {
+		*word &= ~bit;
+	}
+}
+
+void Invert_BitGrid(bitgrid_t *grid) {
+	assert(grid != NULL);
+
+	const uint64_t last_word_mask = Get_LastWordMask(grid);
+
+	for (int y = 0; y < grid->height; y++) {
+		uint64_t *row = &grid->words[y * grid->words_per_row];
+		for (int w = 0; w < grid->words_per_row; w++) {
+			row[w] = ~row[w];
+		}
+		row[grid->words_per_row - 1] &= last_word_mask;
+	}
+}
+
+void Or_BitGridRows(bitgrid_t *grid, const bitgrid_t *other, int first_row, int last_row) {
+	assert(grid != NULL);
+	assert(other != NULL);
+	assert(grid->width == other->width && grid->height == other->height);
+
+	first_row = (first_row < 0) ? 0 : first_row;
+	last_row = (last_row >= grid->height) ? grid->height - 1 : last_row;
+	for (int i = first_row * grid->words_per_row; i < (last_row + 1) * grid->words_per_row; i++) {
+		grid->words[i] |= other->words[i];
+	}
+}
+
+bool Find_BitGridRun(const bitgrid_t *grid, int y, int x, int *run_start, int *run_end) {
+	assert(grid != NULL);
+	assert(y >= 0 && y < grid->height);
+	assert(run_start != NULL && run_end != NULL);
+
+	if (x < 0) {
+		x = 0;
+	}
+	if (x >= grid->width) {
+		return false;
+	}
+
+	const uint64_t *row = &grid->words[y * grid->words_per_row];
+
+	// Find the run's first set cell, ignoring the cells before 'x' in its word.
+	int w = x / BITGRID_WORD_BITS;
+	uint64_t word = row[w] & (~(uint64_t)0 << (x % BITGRID_WORD_BITS));
+	while (word == 0) {
+		if (++w == grid->words_per_row) {
+			return false;
+		}
+		word = row[w];
+	}
+	*run_start = (w * BITGRID_WORD_BITS) + __builtin_ctzll(word);
+
+	// Then the first cleared cell after it. Padding bits are always cleared, so the run ends inside the grid.
+	word = ~row[w] & (~(uint64_t)0 << (*run_start % BITGRID_WORD_BITS));
+	while (word == 0) {
+		if (++w == grid->words_per_row) {
+			*run_end = grid->width;
+			return true;
+		}
+		word = ~row[w];
+	}
+	*run_end = (w * BITGRID_WORD_BITS) + __builtin_ctzll(word);
+	return true;
+}
+
+int Count_BitGridCells(const bitgrid_t *grid) {
+	assert(grid != NULL);
+
+	int count = 0;
+	const int num_words = grid->words_per_row * grid->height;
+	for (int i = 0; i < num_words; i++) {
+		count += __builtin_popcountll(grid->words[i]);
+	}
+	return count;
+}
+
+void Step_BitGridAutomaton(bitgrid_t *grid, bitgrid_t *scratch, int birth_limit, int survival_limit) {
+	assert(grid != NULL);
+	assert(scratch != NULL);
+	assert(grid->width == scratch->width && grid->height == scratch->height);
+
+	const uint64_t OUTSIDE = ~(uint64_t)0;
+	const uint64_t last_word_mask = Get_LastWordMask(grid);
+
+	for (int y = 0; y < grid->height; y++) {
+		for (int w = 0; w < grid->words_per_row; w++) {
+			uint64_t sum[4] = {0, 0, 0, 0};
+			uint64_t centre = 0;
+
+			for (int dy = -1; dy <= 1; dy++) {
+				const uint64_t prev = Get_PaddedWord(grid, y + dy, w - 1, OUTSIDE);
+				const uint64_t curr = Get_PaddedWord(grid, y + dy, w, OUTSIDE);
+				const uint64_t next = Get_PaddedWord(grid, y + dy, w + 1, OUTSIDE);
+
+				// Shift neighbouring columns into place, carrying bits across word boundaries.
+				Add_ToBitSlicedCount(sum, (curr << 1) | (prev >> (BITGRID_WORD_BITS - 1)));
+				Add_ToBitSlicedCount(sum, (curr >> 1) | (next << (BITGRID_WORD_BITS - 1)));
+
+				if (dy == 0) {
+					centre = curr;
+				} else {
+					Add_ToBitSlicedCount(sum, curr);
+				}
+			}
+
+			uint64_t result = (centre & Get_CountAtLeastMask(sum, survival_limit)) | (~centre & Get_CountAtLeastMask(sum, birth_limit));
+			if (w == grid->words_per_row - 1) {
+				result &= last_word_mask;
+			}
+			scratch->words[(y * grid->words_per_row) + w] = result;
+		}
+	}
+
+	uint64_t *tmp = grid->words;
+	grid->words = scratch->words;
+	scratch->words = tmp;
+}
+
+int Flood_BitGrid(bitgrid_t *reached, const bitgrid_t *mask, bitgrid_t *frontier, bitgrid_t *scratch, arena_t *arena, int target_x, int target_y) {
+	assert(reached != NULL);
+	assert(mask != NULL);
+	assert(frontier != NULL);
+	assert(scratch != NULL);
+	assert(arena != NULL);
+	assert(reached->width == mask->width && reached->height == mask->height);
+	assert(reached->width == frontier->width && reached->height == frontier->height);
+	assert(reached->width == scratch->width && reached->height == scratch->height);
+
+	const int height = reached->height;
+	const int words_per_row = reached->words_per_row;
+	const size_t row_size = sizeof(*reached->words) * words_per_row;
+
+	// Flags for the rows of the current layer, and of the layer before it, that hold any cells.
+	const size_t arena_mark = Get_ArenaMark(arena);
+	bool *row_active = Alloc_Arena(arena, sizeof(*row_active) * height * 2);
+	memset(row_active, 0, sizeof(*row_active) * height * 2);
+	bool *prev_row_active = row_active + height;
+
+	// The layers swap buffers as they go, so remember which buffer belongs to which grid.
+	uint64_t *const frontier_words = frontier->words;
+
+	// The first layer is every cell already reached.
+	memcpy(frontier->words, reached->words, row_size * height);
+	memset(scratch->words, 0, row_size * height);
+	int min_row = height;
+	int max_row = -1;
+	for (int y = 0; y < height; y++) {
+		for (int w = 0; w < words_per_row && !row_active[y]; w++) {
+			row_active[y] = (frontier->words[(y * words_per_row) + w] != 0);
+		}
+		if (row_active[y]) {
+			min_row = (y < min_row) ? y : min_row;
+			max_row = y;
+		}
+	}
+
+	int distance = -1;
+	int prev_min_row = height;
+	int prev_max_row = -1;
+
+	for (int layer = 0; min_row <= max_row; layer++) {
+		if (distance == -1 && Get_BitGridCell(reached, target_x, target_y)) {
+			distance = layer;
+		}
+
+		// Visit rows next to the current layer, plus any rows still holding cells from the layer before it (which must be cleared).
+		int first_row = (min_row - 1 < prev_min_row) ? min_row - 1 : prev_min_row;
+		int last_row = (max_row + 1 > prev_max_row) ? max_row + 1 : prev_max_row;
+		first_row = (first_row < 0) ? 0 : first_row;
+		last_row = (last_row >= height) ? height - 1 : last_row;
+		int next_min_row = height;
+		int next_max_row = -1;
+
+		for (int y = first_row; y <= last_row; y++) {
+			const bool above_active = (y > 0 && row_active[y - 1]);
+			const bool below_active = (y < height - 1 && row_active[y + 1]);
+			uint64_t *next_row = &scratch->words[y * words_per_row];
+
+			if (!above_active && !row_active[y] && !below_active) {
+				if (prev_row_active[y]) {
+					memset(next_row, 0, row_size);
+				}
+				prev_row_active[y] = false;
+				continue;
+			}
+
+			const uint64_t *curr_row = &frontier->words[y * words_per_row];
+			const uint64_t *above_row = above_active ? &frontier->words[(y - 1) * words_per_row] : NULL;
+			const uint64_t *below_row = below_active ? &frontier->words[(y + 1) * words_per_row] : NULL;
+			const uint64_t *mask_row = &mask->words[y * words_per_row];
+			uint64_t *reached_row = &reached->words[y * words_per_row];
+			bool next_active = false;
+
+			for (int w = 0; w < words_per_row; w++) {
+				const uint64_t prev = (w > 0) ? curr_row[w - 1] : 0;
+				const uint64_t curr = curr_row[w];
+				const uint64_t next = (w < words_per_row - 1) ? curr_row[w + 1] : 0;
+
+				uint64_t spread = (curr << 1) | (prev >> (BITGRID_WORD_BITS - 1)) | (curr >> 1) | (next << (BITGRID_WORD_BITS - 1));
+				spread |= (above_row != NULL) ? above_row[w] : 0;
+				spread |= (below_row != NULL) ? below_row[w] : 0;
+
+				const uint64_t newly_reached = spread & mask_row[w] & ~reached_row[w];
+				reached_row[w] |= newly_reached;
+				next_row[w] = newly_reached;
+				next_active |= (newly_reached != 0);
+			}
+
+			prev_row_active[y] = next_active;
+			if (next_active) {
+				next_min_row = (y < next_min_row) ? y : next_min_row;
+				next_max_row = y;
+			}
+		}
+
+		// The new layer becomes the current one; the old current layer's buffers are reused for the next.
+		uint64_t *tmp_words = frontier->words;
+		frontier->words = scratch->words;
+		scratch->words = tmp_words;
+
+		bool *tmp_flags = row_active;
+		row_active = prev_row_active;
+		prev_row_active = tmp_flags;
+
+		prev_min_row = min_row;
+		prev_max_row = max_row;
+		min_row = next_min_row;
+		max_row = next_max_row;
+	}
+
+	// Hand each grid back its own buffer, as the grids' storage may have come from different allocators.
+	if (frontier->words != frontier_words) {
+		scratch->words = frontier->words;
+		frontier->words = frontier_words;
+	}
+
+	Restore_ArenaMark(arena, arena_mark);
+	return distance;
+}
@@ -0,0 +1,89 @@
+#ifndef BITGRID_H_
+#define BITGRID_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "arena.h"
+
+#define BITGRID_WORD_BITS 64
+
+typedef struct bitgrid_t {
+	int width;
+	int height;
+	int words_per_row;
+	uint64_t *words;		// Row-major packed cells. Bit (x % 64) of word (x / 64) in row y stores cell (x, y). Padding bits past 'width' are always 0.
+} bitgrid_t;
+
+/*
+	Allocates a bitgrid of 'width' x 'height' cells, with every cell cleared.
+*/
+void Init_BitGrid(bitgrid_t *grid, int width, int height);
+
+/*
+	Allocates a bitgrid of 'width' x 'height' cells from 'arena', with every cell cleared. The cells are released with the arena rather than 'Cleanup_BitGrid'.
+*/
+void Init_BitGridInArena(bitgrid_t *grid, arena_t *arena, int width, int height);
+
+/*
+	Returns the number of arena bytes taken by a bitgrid of 'width' x 'height' cells.
+*/
+size_t Get_BitGridSize(int width, int height);
+
+/*
+	Frees all memory allocated from calling 'Init_BitGrid'.
+*/
+void Cleanup_BitGrid(bitgrid_t *grid);
+
+/*
+	Clears every cell in the bitgrid.
+*/
+void Clear_BitGrid(bitgrid_t *grid);
+
+/*
+	Returns true if the cell at (x, y) is set. Cells outside the grid are never set.
+*/
+bool Get_BitGridCell(const bitgrid_t *grid, int x, int y);
+
+/*
+	Sets or clears the cell at (x, y).
+*/
+void Set_BitGridCell(bitgrid_t *grid, int x, int y, bool value);
+
+/*
+	Flips every cell in the bitgrid (padding bits stay cleared).
+*/
+void Invert_BitGrid(bitgrid_t *grid);
+
+/*
+	Sets every cell in rows 'first_row' to 'last_row' (inclusive, clipped to the grid) that is set in 'other', 64 cells at a time. Rows outside the range are untouched.
+	'other' must have the same dimensions as 'grid'.
+*/
+void Or_BitGridRows(bitgrid_t *grid, const bitgrid_t *other, int first_row, int last_row);
+
+/*
+	Finds the first run of set cells in row 'y' at or after column 'x', skipping 64 cleared cells at a time.
+	Returns false if there is none; otherwise sets 'run_start' to its first column and 'run_end' to the column just past it.
+*/
+bool Find_BitGridRun(const bitgrid_t *grid, int y, int x, int *run_start, int *run_end);
+
+/*
+	Returns the number of set cells in the bitgrid.
+*/
+int Count_BitGridCells(const bitgrid_t *grid);
+
+/*
+	Runs one generation of a cellular automaton over the whole grid, 64 cells at a time. Cells outside the grid count as set.
+	A cleared cell becomes set if at least 'birth_limit' of its 8 neighbours are set; a set cell stays set if at least 'survival_limit' are.
+	'scratch' must have the same dimensions as 'grid' and is swapped with it.
+*/
+void Step_BitGridAutomaton(bitgrid_t *grid, bitgrid_t *scratch, int birth_limit, int survival_limit);
+
+/*
+	Breadth-first flood fills 'mask' from the cells set in 'reached', 64 cells at a time, until every reachable cell is set in 'reached'.
+	Each layer only visits the rows around the previous layer, so sparse floors cost little more than the cells they reach.
+	Returns the number of layers (4-directional steps) needed to reach ('target_x', 'target_y'), or -1 if it is never reached.
+	'frontier' and 'scratch' must have the same dimensions as 'reached'; their contents are overwritten. Per-row flags are taken from 'arena' and released before returning.
+*/
+int Flood_BitGrid(bitgrid_t *reached, const bitgrid_t *mask, bitgrid_t *frontier, bitgrid_t *scratch, arena_t *arena, int target_x, int target_y);
+
+#endif /* BITGRID_H_ */
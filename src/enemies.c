@@ -4,43 +4,206 @@
 #include "ascii_game.h"
 
 static const enemy_data_t g_enemy_data_database[] = {
-	[EnmySlug_ZOMBIE] = {.name = "Zombie", .enemy_slug = EnmySlug_ZOMBIE, .max_health = 5, .sprite = SPR_ZOMBIE},
-	[EnmySlug_WEREWOLF] = {.name = "Werewolf", .enemy_slug = EnmySlug_WEREWOLF, .max_health = 3, .sprite = SPR_WEREWOLF}
+#define ENEMY_DATABASE_ENTRY(name_, sprite_, display_name, max_health_, speed_) [EnmySlug_##name_] = {.name = (display_name), .enemy_slug = EnmySlug_##name_, .max_health = (max_health_), .speed = (speed_), .sprite = SPR_##name_},
+	ENEMY_DATABASE(ENEMY_DATABASE_ENTRY)
+#undef ENEMY_DATABASE_ENTRY
 };
 
 const enemy_data_t* GetEnemyData(const enemy_slug_en enemy_slug) {
 	return &g_enemy_data_database[enemy_slug];
 }
 
-void AddToEnemyList(enemy_node_t **list, enemy_t *enemy) {
-	assert(list != NULL);
-	assert(enemy != NULL);
+/*
+	Returns the number of cells needed to cover 'length' tiles.
+*/
+static int Get_EnemyCellCount(int length) {
+	return (length + ENEMY_CELL_SIZE - 1) / ENEMY_CELL_SIZE;
+}
+
+/*
+	Returns the index of the cell containing the tile at 'pos'.
+*/
+static int Get_EnemyCellIndex(const enemy_pool_t *pool, coord_t pos) {
+	const int cell_x = pos.x / ENEMY_CELL_SIZE;
+	const int cell_y = pos.y / ENEMY_CELL_SIZE;
+	assert(pos.x >= 0 && cell_x < pool->cells_w);
+	assert(pos.y >= 0 && cell_y < pool->cells_h);
+
+	return (cell_x * pool->cells_h) + cell_y;
+}
 
-	enemy_node_t *node = malloc(sizeof(*node));
-	assert(node != NULL);
+/*
+	Files the enemy at 'index' at the front of its position's cell.
+*/
+static void Link_EnemyCell(enemy_pool_t *pool, int index) {
+	const int cell = Get_EnemyCellIndex(pool, pool->enemies[index].pos);
+
+	pool->sleep_cells[index] = cell;
+	pool->cell_prev[index] = ENEMY_NONE;
+	pool->cell_next[index] = pool->cell_heads[cell];
+	if (pool->cell_heads[cell] != ENEMY_NONE) {
+		pool->cell_prev[pool->cell_heads[cell]] = index;
+	}
+	pool->cell_heads[cell] = index;
+}
 
-	node->enemy = enemy;
-	node->next = NULL;
+/*
+	Takes the sleeping enemy at 'index' out of its cell.
+*/
+static void Unlink_EnemyCell(enemy_pool_t *pool, int index) {
+	const int next = pool->cell_next[index];
+	const int prev = pool->cell_prev[index];
 
-	if (*list == NULL) {
-		*list = node;
+	if (prev != ENEMY_NONE) {
+		pool->cell_next[prev] = next;
 	} else {
-		enemy_node_t *searcher = *list;
-		while (searcher->next != NULL) {
-			searcher = searcher->next;
-		}
-		searcher->next = node;
+		pool->cell_heads[pool->sleep_cells[index]] = next;
+	}
+	if (next != ENEMY_NONE) {
+		pool->cell_prev[next] = prev;
 	}
 }
 
-void FreeEnemyList(enemy_node_t **list) {
-	assert(list != NULL);
+/*
+	Adds the enemy at 'index' to the awake set.
+*/
+static void Add_AwakeEnemy(enemy_pool_t *pool, int index) {
+	pool->awake_positions[index] = pool->num_awake;
+	pool->awake_slots[pool->num_awake++] = index;
+}
+
+/*
+	Removes the enemy at 'index' from the awake set, moving the last awake enemy into its place.
+*/
+static void Remove_AwakeEnemy(enemy_pool_t *pool, int index) {
+	const int position = pool->awake_positions[index];
+	const int last_index = pool->awake_slots[--pool->num_awake];
+	pool->awake_slots[position] = last_index;
+	pool->awake_positions[last_index] = position;
+	pool->awake_positions[index] = ENEMY_ASLEEP;
+}
+
+size_t Get_EnemyPoolSize(int capacity, int width, int height) {
+	assert(capacity >= 0);
+	assert(width >= 0 && height >= 0);
 
-	enemy_node_t *tmp;
-	while ((*list) != NULL) {
-		tmp = (*list);
-		(*list) = (*list)->next;
-		free(tmp->enemy);
-		free(tmp);
+	return Get_ArenaAllocSize(sizeof(enemy_t) * capacity) + (Get_ArenaAllocSize(sizeof(int) * capacity) * 8)
+		+ Get_ArenaAllocSize(sizeof(int) * Get_EnemyCellCount(width) * Get_EnemyCellCount(height));
+}
+
+void Init_EnemyPool(enemy_pool_t *pool, arena_t *arena, int capacity, int width, int height) {
+	assert(pool != NULL);
+	assert(arena != NULL);
+	assert(capacity >= 0);
+	assert(width >= 0 && height >= 0);
+
+	pool->capacity = capacity;
+	pool->cells_w = Get_EnemyCellCount(width);
+	pool->cells_h = Get_EnemyCellCount(height);
+	pool->enemies = Alloc_Arena(arena, sizeof(*pool->enemies) * capacity);
+	pool->free_slots = Alloc_Arena(arena, sizeof(*pool->free_slots) * capacity);
+	pool->active_slots = Alloc_Arena(arena, sizeof(*pool->active_slots) * capacity);
+	pool->active_positions = Alloc_Arena(arena, sizeof(*pool->active_positions) * capacity);
+	pool->awake_slots = Alloc_Arena(arena, sizeof(*pool->awake_slots) * capacity);
+	pool->awake_positions = Alloc_Arena(arena, sizeof(*pool->awake_positions) * capacity);
+	pool->cell_next = Alloc_Arena(arena, sizeof(*pool->cell_next) * capacity);
+	pool->cell_prev = Alloc_Arena(arena, sizeof(*pool->cell_prev) * capacity);
+	pool->sleep_cells = Alloc_Arena(arena, sizeof(*pool->sleep_cells) * capacity);
+	pool->cell_heads = Alloc_Arena(arena, sizeof(*pool->cell_heads) * pool->cells_w * pool->cells_h);
+
+	Reset_EnemyPool(pool);
+}
+
+void Reset_EnemyPool(enemy_pool_t *pool) {
+	assert(pool != NULL);
+
+	pool->num_slots = 0;
+	pool->num_free_slots = 0;
+	pool->num_active = 0;
+	pool->num_awake = 0;
+	for (int i = 0; i < pool->cells_w * pool->cells_h; i++) {
+		pool->cell_heads[i] = ENEMY_NONE;
+	}
+}
+
+int AddTo_EnemyPool(enemy_pool_t *pool, enemy_t enemy) {
+	assert(pool != NULL);
+
+	int index;
+	if (pool->num_free_slots > 0) {
+		index = pool->free_slots[--pool->num_free_slots];
+	} else {
+		assert(pool->num_slots < pool->capacity);
+		index = pool->num_slots++;
 	}
-}
\ No newline at end of file
+
+	pool->enemies[index] = enemy;
+	pool->active_positions[index] = pool->num_active;
+	pool->active_slots[pool->num_active++] = index;
+
+	// New enemies sleep until the player comes near their cell.
+	pool->awake_positions[index] = ENEMY_ASLEEP;
+	Link_EnemyCell(pool, index);
+	return index;
+}
+
+void RemoveFrom_EnemyPool(enemy_pool_t *pool, int index) {
+	assert(pool != NULL);
+	assert(index >= 0 && index < pool->num_slots);
+	assert(pool->num_active > 0 && pool->active_slots[pool->active_positions[index]] == index);
+
+	// Move the last active enemy into the removed enemy's place, keeping the active set dense.
+	const int position = pool->active_positions[index];
+	const int last_index = pool->active_slots[--pool->num_active];
+	pool->active_slots[position] = last_index;
+	pool->active_positions[last_index] = position;
+
+	if (pool->awake_positions[index] != ENEMY_ASLEEP) {
+		Remove_AwakeEnemy(pool, index);
+	} else {
+		Unlink_EnemyCell(pool, index);
+	}
+
+	pool->enemies[index].is_alive = false;
+	pool->free_slots[pool->num_free_slots++] = index;
+}
+
+enemy_t* Get_PoolEnemy(const enemy_pool_t *pool, int index) {
+	assert(pool != NULL);
+	assert(index >= 0 && index < pool->num_slots);
+
+	return &pool->enemies[index];
+}
+
+void Wake_EnemyPoolCells(enemy_pool_t *pool, int min_x, int min_y, int max_x, int max_y) {
+	assert(pool != NULL);
+
+	if (max_x < 0 || max_y < 0) {
+		return;
+	}
+
+	const int min_cell_x = (min_x < 0) ? 0 : min_x / ENEMY_CELL_SIZE;
+	const int min_cell_y = (min_y < 0) ? 0 : min_y / ENEMY_CELL_SIZE;
+	const int max_cell_x = (max_x / ENEMY_CELL_SIZE < pool->cells_w) ? max_x / ENEMY_CELL_SIZE : pool->cells_w - 1;
+	const int max_cell_y = (max_y / ENEMY_CELL_SIZE < pool->cells_h) ? max_y / ENEMY_CELL_SIZE : pool->cells_h - 1;
+
+	for (int cell_x = min_cell_x; cell_x <= max_cell_x; cell_x++) {
+		for (int cell_y = min_cell_y; cell_y <= max_cell_y; cell_y++) {
+			// The whole cell wakes at once, emptying its list.
+			const int cell = (cell_x * pool->cells_h) + cell_y;
+			for (int index = pool->cell_heads[cell]; index != ENEMY_NONE; index = pool->cell_next[index]) {
+				Add_AwakeEnemy(pool, index);
+			}
+			pool->cell_heads[cell] = ENEMY_NONE;
+		}
+	}
+}
+
+void Sleep_PoolEnemy(enemy_pool_t *pool, int index) {
+	assert(pool != NULL);
+	assert(index >= 0 && index < pool->num_slots);
+	assert(pool->awake_positions[index] != ENEMY_ASLEEP);
+
+	Remove_AwakeEnemy(pool, index);
+	Link_EnemyCell(pool, index);
+}
@@ -4,19 +4,34 @@
 #include <stdbool.h>
 #include "items.h"
 #include "coord.h"
+#include "arena.h"
+#include "spatial_hash.h"
 
-#define SPR_ZOMBIE 'Z'
-#define SPR_WEREWOLF 'W'
+/*
+	Every enemy in the game as X(name, sprite, display name, max health, speed). Each entry defines the enemy's slug (EnmySlug_name), its sprite (SPR_name),
+	its entry in the enemy data database and how its sprite is decoded from map files, so a new enemy only needs a new entry here.
+*/
+#define ENEMY_DATABASE(X) \
+	X(ZOMBIE,		'Z',	"Zombie",		5,	80) \
+	X(WEREWOLF,		'W',	"Werewolf",		3,	125)
+
+#define ENEMY_SLUG_ENTRY(name, sprite, display_name, max_health, speed) EnmySlug_##name,
+#define ENEMY_SPRITE_ENTRY(name, sprite, display_name, max_health, speed) SPR_##name = (sprite),
 
 typedef enum enemy_slug_en {
-	EnmySlug_ZOMBIE,
-	EnmySlug_WEREWOLF,
+	ENEMY_DATABASE(ENEMY_SLUG_ENTRY)
+	EnmySlug_COUNT			// Number of enemy slugs (not an enemy).
 } enemy_slug_en;
 
+typedef enum enemy_sprite_en {
+	ENEMY_DATABASE(ENEMY_SPRITE_ENTRY)
+} enemy_sprite_en;
+
 typedef struct enemy_data_t {
 	const char *const name;
 	const enemy_slug_en enemy_slug;
 	const int max_health;
+	const int speed;			// Actions per SCHEDULER_TURN_TIME x 100, i.e. 100 acts as often as the player.
 	const char sprite;
 } enemy_data_t;
 
@@ -28,10 +43,29 @@ typedef struct enemy_t {
 	coord_t pos;
 } enemy_t;
 
-typedef struct enemy_node_t {
-	enemy_t *enemy;
-	struct enemy_node_t *next;
-} enemy_node_t;
+#define ENEMY_NONE (-1)							// Enemy index of no enemy.
+#define ENEMY_ASLEEP (-1)						// Awake position of an enemy that is asleep.
+#define ENEMY_CELL_SIZE SPATIAL_CELL_SIZE		// Width and height in tiles of the cells sleeping enemies are bucketed into, the same as the spatial hashes' cells.
+
+typedef struct enemy_pool_t {
+	enemy_t *enemies;			// Dense storage indexed by enemy index. An enemy's index never changes while it is in the pool.
+	int *free_slots;			// Stack of slots released by removed enemies, reused before any new slot.
+	int *active_slots;			// Indices of every enemy in the pool (unordered), so passes over enemies never visit removed ones.
+	int *active_positions;		// Position of each slot's index in 'active_slots'.
+	int *awake_slots;			// Indices of every awake enemy (unordered). Only awake enemies are simulated each turn.
+	int *awake_positions;		// Position of each slot's index in 'awake_slots', or ENEMY_ASLEEP.
+	int *cell_heads;			// First sleeping enemy in each cell (indexed cell x * cells_h + cell y), or ENEMY_NONE.
+	int *cell_next;				// Next sleeping enemy in the same cell, or ENEMY_NONE.
+	int *cell_prev;				// Previous sleeping enemy in the same cell, or ENEMY_NONE for the cell's first.
+	int *sleep_cells;			// Cell each sleeping enemy is filed under.
+	int cells_w;
+	int cells_h;
+	int num_slots;				// Slots handed out since the pool was last reset (live and removed).
+	int num_free_slots;
+	int num_active;				// Enemies currently in the pool.
+	int num_awake;				// Enemies in the pool that are awake. The rest sleep in their cells at no cost per turn.
+	int capacity;				// Fixed when the pool is initialised, as its storage comes from an arena.
+} enemy_pool_t;
 
 /*
 	Returns a pointer to enemy data from the global enemy data database (defined in enemies.c) that matches the 'enemy_slug' arg.
@@ -39,13 +73,45 @@ typedef struct enemy_node_t {
 const enemy_data_t* GetEnemyData(enemy_slug_en enemy_slug);
 
 /*
-	Adds an enemy to a linked list of enemy nodes.
+	Returns the number of arena bytes taken by an enemy pool with room for 'capacity' enemies on a 'width' x 'height' world.
+*/
+size_t Get_EnemyPoolSize(int capacity, int width, int height);
+
+/*
+	Initialises an empty enemy pool with room for 'capacity' enemies on a 'width' x 'height' world, allocating its storage from 'arena'.
+	The storage is released with the arena.
+*/
+void Init_EnemyPool(enemy_pool_t *pool, arena_t *arena, int capacity, int width, int height);
+
+/*
+	Removes every enemy from the pool at once, keeping its storage for the next dungeon floor.
+*/
+void Reset_EnemyPool(enemy_pool_t *pool);
+
+/*
+	Copies an enemy into the pool, which must not be full, asleep in the cell of its position. Returns the enemy's index.
+*/
+int AddTo_EnemyPool(enemy_pool_t *pool, enemy_t enemy);
+
+/*
+	Removes the enemy at 'index' from the pool and its active set (and its awake set or cell), so its slot can be reused by a later enemy.
+*/
+void RemoveFrom_EnemyPool(enemy_pool_t *pool, int index);
+
+/*
+	Wakes every sleeping enemy in the cells overlapping the tiles from (min_x, min_y) to (max_x, max_y), inclusive.
+	Costs one step per cell plus one per enemy woken.
+*/
+void Wake_EnemyPoolCells(enemy_pool_t *pool, int min_x, int min_y, int max_x, int max_y);
+
+/*
+	Puts the awake enemy at 'index' to sleep in the cell of its current position.
 */
-void AddToEnemyList(enemy_node_t **list, enemy_t *enemy);
+void Sleep_PoolEnemy(enemy_pool_t *pool, int index);
 
 /*
-	Frees the memory allocated to a linked list of enemy nodes.
+	Returns the enemy at 'index' in the pool. Keep indices rather than pointers, as a removed enemy's slot is reused.
 */
-void FreeEnemyList(enemy_node_t **list);
+enemy_t* Get_PoolEnemy(const enemy_pool_t *pool, int index);
 
 #endif /* ENEMIES_H_ */
\ No newline at end of file
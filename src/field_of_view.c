@@ -0,0 +1,122 @@
+#include <stdlib.h>
+#include <math.h>
+#include <assert.h>
+#include "field_of_view.h"
+
+/*
+	Converts (depth, column) within each octant to (x, y) offsets from the origin: x = column * xx + depth * xy, y = column * yx + depth * yy.
+*/
+static const int FOV_OCTANT_TRANSFORMS[8][4] = {
+	{ 1,  0,  0,  1}, { 0,  1,  1,  0}, { 0, -1,  1,  0}, {-1,  0,  0,  1},
+	{-1,  0,  0, -1}, { 0, -1, -1,  0}, { 0,  1, -1,  0}, { 1,  0,  0, -1}
+};
+
+typedef struct fov_slope_t {
+	int num;					// Columns per row, as an exact fraction so that cells on a sector's edge are never lost to rounding.
+	int den;
+} fov_slope_t;
+
+typedef struct fov_scan_t {
+	const bitgrid_t *solid;
+	bitgrid_t *visible;
+	coord_t origin;
+	int max_distance_sq;
+	int max_depth;
+	const int *transform;
+} fov_scan_t;
+
+typedef enum fov_cell_en {
+	FovCell_NONE,
+	FovCell_OPEN,
+	FovCell_OPAQUE
+} fov_cell_en;
+
+/*
+	Returns 'num' / 'den' rounded towards positive infinity ('den' must be positive).
+*/
+static int Divide_RoundUp(int num, int den) {
+	return (num >= 0) ? (num + den - 1) / den : -((-num) / den);
+}
+
+/*
+	Returns the slope through the left edge of the cell at 'column', at the middle of row 'depth'. Opaque cells cast their shadows from these edges.
+*/
+static fov_slope_t Get_FovEdgeSlope(int depth, int column) {
+	return (fov_slope_t){.num = (2 * column) - 1, .den = 2 * depth};
+}
+
+/*
+	Returns true if the centre of the cell at ('depth', 'column') lies within the sector from 'start' to 'end'.
+*/
+static bool Check_FovCentreInSector(int depth, int column, fov_slope_t start, fov_slope_t end) {
+	return column * start.den >= depth * start.num && column * end.den <= depth * end.num;
+}
+
+/*
+	Returns true if the cell at ('depth', 'column') in the current octant blocks sight, and sets 'pos' to its world position.
+*/
+static bool Check_FovCellOpaque(const fov_scan_t *scan, int depth, int column, coord_t *pos) {
+	pos->x = scan->origin.x + (column * scan->transform[0]) + (depth * scan->transform[1]);
+	pos->y = scan->origin.y + (column * scan->transform[2]) + (depth * scan->transform[3]);
+	if (pos->x < 0 || pos->x >= scan->solid->width || pos->y < 0 || pos->y >= scan->solid->height) {
+		return true;
+	}
+	return Get_BitGridCell(scan->solid, pos->x, pos->y);
+}
+
+/*
+	Reveals the cells of row 'depth' within the sector from 'start' to 'end', then scans the rows behind each run of open cells, narrowed by the opaque cells around it.
+*/
+static void Scan_FovRow(const fov_scan_t *scan, int depth, fov_slope_t start, fov_slope_t end) {
+	if (depth > scan->max_depth) {
+		return;
+	}
+
+	// The first and last columns whose centres are nearest the sector's edges, rounding ties into the sector.
+	const int min_column = ((2 * depth * start.num) + start.den) / (2 * start.den);
+	const int max_column = Divide_RoundUp((2 * depth * end.num) - end.den, 2 * end.den);
+
+	fov_cell_en previous = FovCell_NONE;
+	for (int column = min_column; column <= max_column; column++) {
+		coord_t pos;
+		const bool opaque = Check_FovCellOpaque(scan, depth, column, &pos);
+		const int distance_sq = (depth * depth) + (column * column);
+
+		if (pos.x >= 0 && pos.x < scan->solid->width && pos.y >= 0 && pos.y < scan->solid->height && distance_sq < scan->max_distance_sq
+			&& (opaque || Check_FovCentreInSector(depth, column, start, end))) {
+			Set_BitGridCell(scan->visible, pos.x, pos.y, true);
+		}
+
+		if (previous == FovCell_OPAQUE && !opaque) {
+			start = Get_FovEdgeSlope(depth, column);
+		} else if (previous == FovCell_OPEN && opaque) {
+			Scan_FovRow(scan, depth + 1, start, Get_FovEdgeSlope(depth, column));
+		}
+		previous = opaque ? FovCell_OPAQUE : FovCell_OPEN;
+	}
+
+	if (previous == FovCell_OPEN) {
+		Scan_FovRow(scan, depth + 1, start, end);
+	}
+}
+
+void Compute_FieldOfView(const bitgrid_t *solid, bitgrid_t *visible, coord_t origin, int max_distance_sq) {
+	assert(solid != NULL);
+	assert(visible != NULL);
+	assert(solid->width == visible->width && solid->height == visible->height);
+
+	Clear_BitGrid(visible);
+	if (origin.x < 0 || origin.x >= solid->width || origin.y < 0 || origin.y >= solid->height || max_distance_sq <= 0) {
+		return;
+	}
+
+	Set_BitGridCell(visible, origin.x, origin.y, true);
+
+	// Cells one row further than this are always out of reach.
+	fov_scan_t scan = {.solid = solid, .visible = visible, .origin = origin, .max_distance_sq = max_distance_sq};
+	scan.max_depth = (int)ceil(sqrt(max_distance_sq));
+	for (int octant = 0; octant < 8; octant++) {
+		scan.transform = FOV_OCTANT_TRANSFORMS[octant];
+		Scan_FovRow(&scan, 1, (fov_slope_t){.num = 0, .den = 1}, (fov_slope_t){.num = 1, .den = 1});
+	}
+}
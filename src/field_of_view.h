@@ -0,0 +1,15 @@
+#ifndef FIELD_OF_VIEW_H_
+#define FIELD_OF_VIEW_H_
+
+#include "coord.h"
+#include "bitgrid.h"
+
+/*
+	Sets the cells of 'visible' that can be seen from 'origin', by symmetric recursive shadowcasting over the 8 octants around it, treating the cells set in 'solid' as opaque.
+	Only cells whose squared distance from 'origin' is below 'max_distance_sq' are seen. Opaque cells are seen if any part of them is in view, but open cells only if their
+	centre is, so an open cell 'a' sees an open cell 'b' exactly when 'b' sees 'a'. Cells outside the grid block sight.
+	'visible' must have the same dimensions as 'solid'; it is cleared a word at a time, and only the cells within reach of 'origin' are visited.
+*/
+void Compute_FieldOfView(const bitgrid_t *solid, bitgrid_t *visible, coord_t origin, int max_distance_sq);
+
+#endif // !FIELD_OF_VIEW_H_
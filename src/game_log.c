@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <assert.h>
+#include "game_log.h"
+#include "session_log.h"
+
+#define LOG_EVENT_FORMAT_ENTRY(name, arg_types) [LogEvent_##name] = LOGMSG_##name,
+#define LOG_EVENT_ARGS_ENTRY(name, arg_types) [LogEvent_##name] = (arg_types),
+
+static const char *const LOG_EVENT_FORMATS[LogEvent_COUNT] = {
+	LOG_EVENT_DATABASE(LOG_EVENT_FORMAT_ENTRY)
+	[LogEvent_TEXT] = "%s"
+};
+
+static const char *const LOG_EVENT_ARGS[LogEvent_COUNT] = {
+	LOG_EVENT_DATABASE(LOG_EVENT_ARGS_ENTRY)
+	[LogEvent_TEXT] = ""
+};
+
+#undef LOG_EVENT_FORMAT_ENTRY
+#undef LOG_EVENT_ARGS_ENTRY
+
+/*
+	Scrolls the bottom panel's rows down by one, showing 'entry_index' (or LOG_PANEL_BLANK) on the newest row.
+*/
+static void Push_GameLogPanelRow(log_list_t *game_log, int entry_index) {
+	for (int row = LOG_LINES_SHOWN - 1; row > 0; row--) {
+		game_log->panel_rows[row] = game_log->panel_rows[row - 1];
+	}
+	game_log->panel_rows[0] = entry_index;
+}
+
+/*
+	Makes room for a new entry in place of the oldest once the history is full, and returns it, counted towards the stats of 'event'.
+	The entry also scrolls onto the bottom panel.
+*/
+static log_entry_t* Push_GameLogEntry(log_list_t *game_log, log_event_en event) {
+	game_log->newest = (game_log->newest + 1) % LOG_CAPACITY;
+	if (game_log->num_lines < LOG_CAPACITY) {
+		game_log->num_lines++;
+	}
+
+	log_entry_t *entry = &game_log->entries[game_log->newest];
+	entry->event = event;
+	entry->formatted = false;
+	game_log->event_stats[event].count++;
+	Push_GameLogPanelRow(game_log, game_log->newest);
+	return entry;
+}
+
+void Format_GameLogEntry(const log_entry_t *entry, char *line) {
+	assert(entry != NULL);
+	assert(line != NULL);
+
+	const char *format = LOG_EVENT_FORMATS[entry->event];
+	const char *arg_types = LOG_EVENT_ARGS[entry->event];
+	const log_arg_t *args = entry->args;
+
+	if (strcmp(arg_types, "") == 0) {
+		snprintf(line, LOG_BUFFER_SIZE, "%s", format);
+	} else if (strcmp(arg_types, "i") == 0) {
+		snprintf(line, LOG_BUFFER_SIZE, format, args[0].number);
+	} else if (strcmp(arg_types, "s") == 0) {
+		snprintf(line, LOG_BUFFER_SIZE, format, args[0].text);
+	} else if (strcmp(arg_types, "si") == 0) {
+		snprintf(line, LOG_BUFFER_SIZE, format, args[0].text, args[1].number);
+	} else if (strcmp(arg_types, "ss") == 0) {
+		snprintf(line, LOG_BUFFER_SIZE, format, args[0].text, args[1].text);
+	} else {
+		// Every argument type string in LOG_EVENT_DATABASE must be handled above.
+		assert(false);
+	}
+}
+
+void Init_GameLog(log_list_t *game_log) {
+	assert(game_log != NULL);
+
+	game_log->entries = malloc(sizeof(*game_log->entries) * LOG_CAPACITY);
+	assert(game_log->entries != NULL);
+	game_log->lines = malloc(sizeof(*game_log->lines) * LOG_CAPACITY);
+	assert(game_log->lines != NULL);
+	game_log->newest = LOG_CAPACITY - 1;
+	game_log->num_lines = 0;
+	memset(game_log->event_stats, 0, sizeof(game_log->event_stats));
+	for (int row = 0; row < LOG_LINES_SHOWN; row++) {
+		game_log->panel_rows[row] = LOG_PANEL_BLANK;
+	}
+	game_log->session_log = NULL;
+}
+
+void Cleanup_GameLog(log_list_t *game_log) {
+	assert(game_log != NULL);
+
+	free(game_log->entries);
+	game_log->entries = NULL;
+	free(game_log->lines);
+	game_log->lines = NULL;
+}
+
+void Log_GameEvent(log_list_t *game_log, log_event_en event, ...) {
+	assert(game_log != NULL);
+	assert(event >= 0 && event < LogEvent_TEXT);
+
+	log_entry_t *entry = Push_GameLogEntry(game_log, event);
+	const char *arg_types = LOG_EVENT_ARGS[event];
+	assert(strlen(arg_types) <= LOG_EVENT_MAX_ARGS);
+
+	va_list argp;
+	va_start(argp, event);
+	bool counted = false;
+	for (int i = 0; arg_types[i] != '\0'; i++) {
+		if (arg_types[i] == 'i') {
+			entry->args[i].number = va_arg(argp, int);
+
+			// Only the first int argument adds to the event's total.
+			if (!counted) {
+				game_log->event_stats[event].total += entry->args[i].number;
+				counted = true;
+			}
+		} else {
+			entry->args[i].text = va_arg(argp, const char*);
+		}
+	}
+	va_end(argp);
+
+	if (game_log->session_log != NULL) {
+		Push_SessionLogEvent(game_log->session_log, entry);
+	}
+}
+
+void Update_GameLog(log_list_t *game_log, const char *format, ...) {
+	assert(game_log != NULL);
+
+	// Free text can't be formatted later, as its arguments may be gone by then.
+	log_entry_t *entry = Push_GameLogEntry(game_log, LogEvent_TEXT);
+	entry->formatted = true;
+
+	va_list argp;
+	va_start(argp, format);
+	vsnprintf(game_log->lines[game_log->newest], LOG_BUFFER_SIZE, format, argp);
+	va_end(argp);
+
+	if (game_log->session_log != NULL) {
+		Push_SessionLogText(game_log->session_log, game_log->lines[game_log->newest]);
+	}
+}
+
+const char* Get_GameLogLine(log_list_t *game_log, int age) {
+	assert(game_log != NULL);
+	assert(age >= 0);
+
+	if (age >= game_log->num_lines) {
+		return LOGMSG_EMPTY_SPACE;
+	}
+
+	const int index = (game_log->newest - age + LOG_CAPACITY) % LOG_CAPACITY;
+	log_entry_t *entry = &game_log->entries[index];
+	if (!entry->formatted) {
+		Format_GameLogEntry(entry, game_log->lines[index]);
+		entry->formatted = true;
+	}
+	return game_log->lines[index];
+}
+
+void Scroll_GameLogPanel(log_list_t *game_log) {
+	assert(game_log != NULL);
+
+	for (int row = 0; row < LOG_LINES_SHOWN; row++) {
+		if (game_log->panel_rows[row] != LOG_PANEL_BLANK) {
+			Push_GameLogPanelRow(game_log, LOG_PANEL_BLANK);
+			return;
+		}
+	}
+}
+
+const char* Get_GameLogPanelLine(log_list_t *game_log, int row) {
+	assert(game_log != NULL);
+	assert(row >= 0 && row < LOG_LINES_SHOWN);
+
+	// A panel row is always among the newest LOG_LINES_SHOWN entries, so its entry is never overwritten while it is shown.
+	const int index = game_log->panel_rows[row];
+	if (index == LOG_PANEL_BLANK) {
+		return LOGMSG_EMPTY_SPACE;
+	}
+	return Get_GameLogLine(game_log, (game_log->newest - index + LOG_CAPACITY) % LOG_CAPACITY);
+}
+
+const log_entry_t* Get_GameLogEntry(const log_list_t *game_log, int age) {
+	assert(game_log != NULL);
+	assert(age >= 0);
+
+	if (age >= game_log->num_lines) {
+		return NULL;
+	}
+	return &game_log->entries[(game_log->newest - age + LOG_CAPACITY) % LOG_CAPACITY];
+}
+
+log_event_stats_t Get_GameLogEventStats(const log_list_t *game_log, log_event_en event) {
+	assert(game_log != NULL);
+	assert(event >= 0 && event < LogEvent_COUNT);
+
+	return game_log->event_stats[event];
+}
@@ -0,0 +1,92 @@
+#ifndef GAME_LOG_H_
+#define GAME_LOG_H_
+
+#include <stdbool.h>
+#include "log_messages.h"
+
+#define LOG_BUFFER_SIZE 175
+#define LOG_CAPACITY 4096				// Messages kept in the game log's history. Once it is full, each new message takes the place of the oldest.
+#define LOG_LINES_SHOWN 5				// Newest game log messages shown in the bottom panel.
+#define LOG_PANEL_BLANK (-1)			// Entry index of a blank row of the bottom panel.
+#define LOG_EVENT_MAX_ARGS 2
+
+typedef union log_arg_t {
+	int number;
+	const char *text;			// Must outlive the log, as it is only read when the message is formatted (names from the item and enemy databases do).
+} log_arg_t;
+
+typedef struct log_entry_t {
+	log_event_en event;
+	log_arg_t args[LOG_EVENT_MAX_ARGS];
+	bool formatted;				// Whether the entry's line of text has been formatted yet.
+} log_entry_t;
+
+typedef struct log_event_stats_t {
+	int count;					// Times the event has been logged since the log was initialised, including those since overwritten.
+	long long total;			// Sum of the event's first int argument over those times (0 if it has none).
+} log_event_stats_t;
+
+typedef struct log_list_t {
+	log_entry_t *entries;			// Ring buffer of LOG_CAPACITY events, written in place so no entry is ever moved.
+	char (*lines)[LOG_BUFFER_SIZE];	// Formatted text of each entry, filled in the first time the entry is read.
+	int newest;						// Index in 'entries' of the newest entry.
+	int num_lines;					// Entries in the history, up to LOG_CAPACITY.
+	log_event_stats_t event_stats[LogEvent_COUNT];
+	int panel_rows[LOG_LINES_SHOWN];	// Index in 'entries' of the entry on each row of the bottom panel (newest first), or LOG_PANEL_BLANK.
+	struct session_log_t *session_log;	// If not NULL, every entry is also pushed to this log of the whole session.
+} log_list_t;
+
+/*
+	Initialises an empty game log, allocating room for its whole history up front.
+*/
+void Init_GameLog(log_list_t *game_log);
+
+/*
+	Frees all memory allocated from calling 'Init_GameLog'.
+*/
+void Cleanup_GameLog(log_list_t *game_log);
+
+/*
+	Adds 'event' to the game log, with the arguments its LOGMSG_ macro takes, in place of the oldest entry once the history is full.
+	Only the event and its arguments are stored: the text isn't formatted until it is read. O(1), however long the history.
+*/
+void Log_GameEvent(log_list_t *game_log, log_event_en event, ...);
+
+/*
+	Adds a new formatted line of free text to the game log, formatting it straight away. Prefer 'Log_GameEvent' for any message in 'LOG_EVENT_DATABASE'.
+*/
+void Update_GameLog(log_list_t *game_log, const char *format, ...);
+
+/*
+	Formats the text of 'entry' into 'line' (LOG_BUFFER_SIZE chars), from its event's LOGMSG_ macro and its arguments. Only reads the entry, so any thread may call it.
+*/
+void Format_GameLogEntry(const log_entry_t *entry, char *line);
+
+/*
+	Returns the text of the game log entry 'age' entries older than the newest (0 for the newest), or a blank line if the history doesn't go back that far.
+	The entry's text is formatted the first time it is read, and kept until the entry is overwritten, which is why reading a line takes a non-const log.
+*/
+const char* Get_GameLogLine(log_list_t *game_log, int age);
+
+/*
+	Scrolls a blank row into the bottom panel, unless the panel is already blank, so old messages leave it over quiet turns.
+	The blank row is only shown in the panel: nothing is added to the history (or its stats, or the session log).
+*/
+void Scroll_GameLogPanel(log_list_t *game_log);
+
+/*
+	Returns the text on row 'row' of the bottom panel (0 for the newest), or a blank line for a row scrolled blank or never filled.
+*/
+const char* Get_GameLogPanelLine(log_list_t *game_log, int row);
+
+/*
+	Returns the game log entry 'age' entries older than the newest (0 for the newest), or NULL if the history doesn't go back that far.
+*/
+const log_entry_t* Get_GameLogEntry(const log_list_t *game_log, int age);
+
+/*
+	Returns how many times 'event' has been logged, and the sum of its first int argument over those times (e.g. gold picked up or damage dealt), from running totals.
+*/
+log_event_stats_t Get_GameLogEventStats(const log_list_t *game_log, log_event_en event);
+
+#endif // !GAME_LOG_H_
@@ -112,9 +112,10 @@ void GEO_show_screen(void) {
 		for (int x = 0; x < w; x++) {
 			if (front_px[y][x] != back_px[y][x] || front_px_color[y][x] != back_px_color[y][x]) {
 				if (has_colors()) {
-					attron(COLOR_PAIR(front_px_color[y][x]));
+					const int attributes = COLOR_PAIR(front_px_color[y][x] & ~GEO_DIM) | ((front_px_color[y][x] & GEO_DIM) ? A_DIM : 0);
+					attron(attributes);
 					mvaddch(y, x, front_px[y][x]);
-					attroff(COLOR_PAIR(front_px_color[y][x]));
+					attroff(attributes);
 				} else {
 					mvaddch(y, x, front_px[y][x]);
 				}
@@ -146,6 +147,19 @@ void GEO_draw_char(const int x, const int y, const int color, const char value)
 	}
 }
 
+void GEO_draw_row(int x, int y, const char *values, const int *colors, int length) {
+	if (GEO_zdk_screen != NULL && y >= 0 && y < GEO_zdk_screen->height) {
+		// Clip the row to the screen, then copy it in one go.
+		const int first = MAX(x, 0);
+		const int last = MIN(x + length, GEO_zdk_screen->width);
+
+		if (first < last) {
+			memcpy(&GEO_zdk_screen->pixels[y][first], &values[first - x], sizeof(*values) * (last - first));
+			memcpy(&GEO_zdk_screen->px_color[y][first], &colors[first - x], sizeof(*colors) * (last - first));
+		}
+	}
+}
+
 void GEO_draw_line(int x1, int y1, int x2, int y2, const int color, const char value) {
 	if (x1 == x2) {
 		// Draw vertical line
@@ -3,6 +3,8 @@
 
 #include <stdarg.h>
 
+#define GEO_DIM 0x100		// OR-ed into a colour to draw it dimmed.
+
 typedef struct GEO_Screen {
 	int width;
 	int height;
@@ -19,6 +21,7 @@ void GEO_clear_screen(void);
 void GEO_show_screen(void);
 
 void GEO_draw_char(int x, int y, int color, char value);
+void GEO_draw_row(int x, int y, const char *values, const int *colors, int length);
 void GEO_drawf(int x, int y, int color, const char *format, ...);
 void GEO_drawf_align_center(int x_offset, int y, int color, const char *format, ...);
 void GEO_drawf_align_right(int x_offset, int y, int color, const char *format, ...);
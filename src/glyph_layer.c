@@ -0,0 +1,34 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "glyph_layer.h"
+
+size_t Get_GlyphLayerSize(int width, int height) {
+	assert(width >= 0 && height >= 0);
+
+	return Get_ArenaAllocSize(sizeof(char) * width * height) + Get_ArenaAllocSize(sizeof(int) * width * height);
+}
+
+void Init_GlyphLayer(glyph_layer_t *layer, arena_t *arena, int width, int height) {
+	assert(layer != NULL);
+	assert(arena != NULL);
+	assert(width >= 0 && height >= 0);
+
+	layer->width = width;
+	layer->height = height;
+	layer->sprites = Alloc_Arena(arena, sizeof(*layer->sprites) * width * height);
+	layer->colours = Alloc_Arena(arena, sizeof(*layer->colours) * width * height);
+
+	// Blank glyphs, in the first colour (white).
+	memset(layer->sprites, ' ', sizeof(*layer->sprites) * width * height);
+	memset(layer->colours, 0, sizeof(*layer->colours) * width * height);
+}
+
+void Set_Glyph(glyph_layer_t *layer, coord_t pos, char sprite, int colour) {
+	assert(layer != NULL);
+	assert(pos.x >= 0 && pos.x < layer->width);
+	assert(pos.y >= 0 && pos.y < layer->height);
+
+	layer->sprites[(pos.y * layer->width) + pos.x] = sprite;
+	layer->colours[(pos.y * layer->width) + pos.x] = colour;
+}
@@ -0,0 +1,29 @@
+#ifndef GLYPH_LAYER_H_
+#define GLYPH_LAYER_H_
+
+#include "coord.h"
+#include "arena.h"
+
+typedef struct glyph_layer_t {
+	int width;
+	int height;
+	char *sprites;				// Row-major (index y * width + x) like the screen buffer, so a row of glyphs can be copied to the screen at once.
+	int *colours;
+} glyph_layer_t;
+
+/*
+	Returns the number of arena bytes taken by a glyph layer of 'width' x 'height' glyphs.
+*/
+size_t Get_GlyphLayerSize(int width, int height);
+
+/*
+	Initialises a glyph layer of 'width' x 'height' blank glyphs, allocating its storage from 'arena'. The storage is released with the arena.
+*/
+void Init_GlyphLayer(glyph_layer_t *layer, arena_t *arena, int width, int height);
+
+/*
+	Sets the glyph at 'pos' to 'sprite' drawn in 'colour'.
+*/
+void Set_Glyph(glyph_layer_t *layer, coord_t pos, char sprite, int colour);
+
+#endif // !GLYPH_LAYER_H_
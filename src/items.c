@@ -4,8 +4,9 @@
 
 static const item_t g_item_database[] = {
 	[ItmSlug_NONE] = {.name = "Empty", .sprite = SPR_EMPTY, .item_slug = ItmSlug_NONE, .value = 0},
-	[ItmSlug_SMALLFOOD] = {.name = "Small food", .sprite = SPR_SMALLFOOD, .item_slug = ItmSlug_SMALLFOOD, .value = 20},
-	[ItmSlug_BIGFOOD] = {.name = "Big food", .sprite = SPR_BIGFOOD, .item_slug = ItmSlug_BIGFOOD, .value = 35}
+#define ITEM_DATABASE_ENTRY(name_, sprite_, display_name, value_) [ItmSlug_##name_] = {.name = (display_name), .sprite = SPR_##name_, .item_slug = ItmSlug_##name_, .value = (value_)},
+	ITEM_DATABASE(ITEM_DATABASE_ENTRY)
+#undef ITEM_DATABASE_ENTRY
 };
 
 const item_t* GetItem(const item_slug_en item_slug) {
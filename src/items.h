@@ -1,15 +1,27 @@
 #ifndef ITEMS_H_
 #define ITEMS_H_
 
-#define SPR_SMALLFOOD 'f'
-#define SPR_BIGFOOD 'F'
+/*
+	Every item in the game as X(name, sprite, display name, value). Each entry defines the item's slug (ItmSlug_name), its sprite (SPR_name),
+	its entry in the item database and how its sprite is decoded from map files, so a new item only needs a new entry here.
+*/
+#define ITEM_DATABASE(X) \
+	X(SMALLFOOD,	'f',	"Small food",	20) \
+	X(BIGFOOD,		'F',	"Big food",		35)
+
+#define ITEM_SLUG_ENTRY(name, sprite, display_name, value) ItmSlug_##name,
+#define ITEM_SPRITE_ENTRY(name, sprite, display_name, value) SPR_##name = (sprite),
 
 typedef enum item_slug_en {
-	ItmSlug_NONE,
-	ItmSlug_SMALLFOOD,
-	ItmSlug_BIGFOOD
+	ItmSlug_NONE,			// No item (e.g. an empty inventory slot).
+	ITEM_DATABASE(ITEM_SLUG_ENTRY)
+	ItmSlug_COUNT			// Number of item slugs (not an item).
 } item_slug_en;
 
+typedef enum item_sprite_en {
+	ITEM_DATABASE(ITEM_SPRITE_ENTRY)
+} item_sprite_en;
+
 typedef struct item_t {
 	const char *const name;
 	const char sprite;
@@ -23,9 +23,43 @@
 #define LOGMSG_PLR_INSUFFICIENT_GOLD_MERCHANT "Merchant: \"I won't offer any lower for this item!\""
 
 #define LOGMSG_ENEMY_DMG_PLR "%s hit you for %d dmg."
+#define LOGMSG_ENEMY_DROP_LOOT "%s dropped %s."
 
 #define LOGMSG_WELCOME "Welcome to Asciiscape!"
 
 #define LOGMSG_EMPTY_SPACE " "
 
+// Every message the game logs as an event, with the types of its arguments in order ('i' for an int, 's' for a string). Each event's text is its LOGMSG_ macro.
+#define LOG_EVENT_DATABASE(X) \
+	X(PLR_GET_GOLD_SINGLE,					"i") \
+	X(PLR_GET_GOLD_PLURAL,					"i") \
+	X(PLR_USE_FOOD,							"i") \
+	X(PLR_USE_FOOD_FULL,					"") \
+	X(PLR_GET_ITEM,							"s") \
+	X(PLR_DROP_ITEM,						"s") \
+	X(PLR_CANT_DROP_ITEM,					"") \
+	X(PLR_INVENTORY_FULL,					"") \
+	X(PLR_DMG_ENEMY,						"si") \
+	X(PLR_KILL_ENEMY,						"s") \
+	X(PLR_INTERACT_STAIRCASE,				"") \
+	X(PLR_NEW_FLOOR,						"i") \
+	X(EXAMINE_SMALL_FOOD,					"") \
+	X(EXAMINE_BIG_FOOD,						"") \
+	X(PLR_TALK_MERCHANT,					"") \
+	X(PLR_BUY_MERCHANT,						"s") \
+	X(PLR_BUY_FULL_MERCHANT,				"") \
+	X(PLR_INSUFFICIENT_GOLD_MERCHANT,		"") \
+	X(ENEMY_DMG_PLR,						"si") \
+	X(ENEMY_DROP_LOOT,						"ss") \
+	X(WELCOME,								"") \
+	X(EMPTY_SPACE,							"")
+
+#define LOG_EVENT_ENTRY(name, arg_types) LogEvent_##name,
+
+typedef enum log_event_en {
+	LOG_EVENT_DATABASE(LOG_EVENT_ENTRY)
+	LogEvent_TEXT,			// Free text, formatted as soon as it is logged.
+	LogEvent_COUNT			// Number of log events (not an event).
+} log_event_en;
+
 #endif // !LOG_MESSAGES_H_
\ No newline at end of file
@@ -2,14 +2,17 @@
 #include <stdio.h>
 #include <assert.h>
 #include <stdbool.h>
+#include <unistd.h>
 #include "george_graphics.h"
 #include "log_messages.h"
 #include "ascii_game.h"
+#include "prefabs.h"
+#include "session_log.h"
 #include "main.h"
 
 int main(int argc, char *argv[]) {
 	if (argc < 2) {
-		fprintf(stderr, "Run with: ./ascii_game [num_rooms]\n");
+		fprintf(stderr, "Run with: ./ascii_game [num_rooms] [optional: session_log_file]\n");
 		exit(1);
 	}
 
@@ -17,40 +20,65 @@ int main(int argc, char *argv[]) {
 	int num_rooms_specified = (int)strtol(argv[1], 0, 0);
 	num_rooms_specified = CLAMP(num_rooms_specified, MIN_ROOMS, MAX_ROOMS);
 
+	// Every game log message and turn summary is also written to the session log file, if one is given, for post-mortems. If it can't be created, the game runs without it.
+	session_log_t session_log;
+	bool session_log_enabled = (argc >= 3);
+	if (session_log_enabled && !Init_SessionLog(&session_log, argv[2], SESSION_LOG_CAPACITY)) {
+		fprintf(stderr, "The session log file \"%s\" could not be created. Running without a session log...\n", argv[2]);
+		session_log_enabled = false;
+	}
+
 	// Initialise curses.
 	GEO_setup_screen();
 
-	// Ensure the terminal size is large enough to create the hub file.
-	FILE *fp;
-	fp = fopen(HUB_FILENAME, "r");
-	if (fp == NULL) {
-		fprintf(stderr, "The game's hub file \"%s\" could not be found. Exiting...\n", HUB_FILENAME);
+	// Parse the hub once up front (falling back to its txt source if it hasn't been compiled), and ensure the terminal size is large enough to create it.
+	map_template_t hub_template;
+	if (!Init_MapTemplate(&hub_template, HUB_FILENAME) && !Init_MapTemplate(&hub_template, HUB_SOURCE_FILENAME)) {
 		GEO_cleanup_screen();
-		fclose(fp);
+		if (session_log_enabled) {
+			Cleanup_SessionLog(&session_log);
+		}
+		fprintf(stderr, "The game's hub file could not be found as \"%s\" or \"%s\". Exiting...\n", HUB_FILENAME, HUB_SOURCE_FILENAME);
 		exit(1);
 	} else {
-		dimensions_t hub_file_dimensions = GetFileDimensions(fp);
-		int min_width = hub_file_dimensions.x + RIGHT_PANEL_OFFSET;
-		int min_height = hub_file_dimensions.y + BOTTOM_PANEL_OFFSET;
+		int min_width = hub_template.width + RIGHT_PANEL_OFFSET;
+		int min_height = hub_template.height + BOTTOM_PANEL_OFFSET;
 
 		if (GEO_screen_width() < min_width || GEO_screen_height() < min_height) {
+			Cleanup_MapTemplate(&hub_template);
 			GEO_cleanup_screen();
+			if (session_log_enabled) {
+				Cleanup_SessionLog(&session_log);
+			}
 			fprintf(stderr, "The current terminal size must be at least (%dx%d) to run the game. Exiting...\n",
 				min_width, min_height);
 			exit(1);
 		}
 	}
 
+	// Parse the prefab rooms once up front. Without them, floors are generated from plain rooms only.
+	prefab_library_t prefab_library;
+	Init_PrefabLibrary(&prefab_library, PREFAB_DIRECTORY);
+
 	// Initialise the game.
 	game_state_t game_state;
 	Init_GameState(&game_state);
 	game_state.player = Create_Player();
+	game_state.prefab_library = &prefab_library;
+	game_state.game_log.session_log = session_log_enabled ? &session_log : NULL;
+
+	// Enemy actions are planned across the machine's cores.
+	thread_pool_t enemy_planners;
+	Init_ThreadPool(&enemy_planners, CLAMP((int)sysconf(_SC_NPROCESSORS_ONLN), 1, MAX_ENEMY_PLANNER_THREADS));
+	game_state.enemy_planners = &enemy_planners;
 
-	const char *filename = NULL;
+	// Every few floors, a cave layout is created instead of rooms (hub floors aside).
+	const map_template_t *map_template = NULL;
+	floor_layout_en layout = (game_state.current_floor % CAVE_MAP_FREQUENCY == 0) ? FloorLayout_CAVE : FloorLayout_BSP;
 
 	Draw_HelpScreen(&game_state);
-	Update_GameLog(&game_state.game_log, LOGMSG_WELCOME);
-	InitCreate_DungeonFloor(&game_state, num_rooms_specified, filename);
+	Log_GameEvent(&game_state.game_log, LogEvent_WELCOME);
+	InitCreate_DungeonFloor(&game_state, num_rooms_specified, layout, map_template);
 
 	// Main game loop.
 	while (!g_process_over) {
@@ -63,20 +91,27 @@ int main(int argc, char *argv[]) {
 
 			// Every few floors, the hub layout is created instead of a random dungeon layout.
 			if (game_state.current_floor % HUB_MAP_FREQUENCY == 0) {
-				filename = HUB_FILENAME;
+				map_template = &hub_template;
 				game_state.player.stats.max_vision = PLAYER_MAX_VISION + 100;
 			} else {
-				filename = NULL;
+				map_template = NULL;
 				game_state.player.stats.max_vision = PLAYER_MAX_VISION;
 			}
+			layout = (map_template == NULL && game_state.current_floor % CAVE_MAP_FREQUENCY == 0) ? FloorLayout_CAVE : FloorLayout_BSP;
 
-			InitCreate_DungeonFloor(&game_state, num_rooms_specified, filename);
+			InitCreate_DungeonFloor(&game_state, num_rooms_specified, layout, map_template);
 		}
 	}
 
 	// Cleanup dynamically allocated memory.
 	Cleanup_DungeonFloor(&game_state);
 	Cleanup_GameState(&game_state);
+	Cleanup_ThreadPool(&enemy_planners);
+	Cleanup_PrefabLibrary(&prefab_library);
+	Cleanup_MapTemplate(&hub_template);
+	if (session_log_enabled) {
+		Cleanup_SessionLog(&session_log);
+	}
 
 	// Terminate curses.
 	GEO_cleanup_screen();
@@ -100,21 +135,3 @@ bool FContainsChar(FILE *fp, char char_to_find) {
 	}
 	return false;
 }
-
-dimensions_t GetFileDimensions(FILE *fp) {
-	int lineNum = 0;
-	size_t len = 0;
-	char *line = NULL;
-	ssize_t read = 0;
-
-	int longest_line = 0;
-	while ((read = getline(&line, &len, fp)) != -1) {
-		if (read > longest_line) {
-			longest_line = read;
-		}
-		lineNum++;
-	}
-	
-	dimensions_t result = {.x = longest_line - 1, .y = lineNum};	//Longest line - 1 to remove the newline character.
-	return result;
-}
\ No newline at end of file
@@ -3,12 +3,8 @@
 
 #include <stdio.h>
 
-typedef struct dimensions_t {
-	int x;
-	int y;
-} dimensions_t;
+#define MAX_ENEMY_PLANNER_THREADS 8
 
 bool FContainsChar(FILE *fp, char char_to_find);
-dimensions_t GetFileDimensions(FILE *fp);
 
 #endif // !MAIN_H_
\ No newline at end of file
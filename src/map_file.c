@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "map_file.h"
+
+#define MAP_FILE_INITIAL_LINES 64
+
+bool Open_MapFileData(map_file_t *map, const char *filename) {
+	assert(map != NULL);
+	assert(filename != NULL);
+
+	memset(map, 0, sizeof(*map));
+
+	const int fd = open(filename, O_RDONLY);
+	if (fd == -1) {
+		return false;
+	}
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) == -1) {
+		close(fd);
+		return false;
+	}
+
+	map->size = (size_t)file_stat.st_size;
+	if (map->size > 0) {
+		map->data = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map->data == MAP_FAILED) {
+			close(fd);
+			memset(map, 0, sizeof(*map));
+			return false;
+		}
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	close(fd);
+	return true;
+}
+
+void Find_MapFileLines(map_file_t *map) {
+	assert(map != NULL);
+	assert(map->lines == NULL);
+
+	// A single scan records every line's extents. A final line without a trailing newline still counts.
+	int lines_capacity = MAP_FILE_INITIAL_LINES;
+	map->lines = malloc(sizeof(*map->lines) * lines_capacity);
+	assert(map->lines != NULL);
+
+	const char *line_start = map->data;
+	const char *end = map->data + map->size;
+	while (line_start < end) {
+		const char *line_end = memchr(line_start, '\n', (size_t)(end - line_start));
+		const char *next_line = (line_end != NULL) ? line_end + 1 : end;
+		line_end = (line_end != NULL) ? line_end : end;
+
+		// Tolerate maps saved with Windows line endings.
+		if (line_end > line_start && line_end[-1] == '\r') {
+			line_end--;
+		}
+
+		if (map->num_lines == lines_capacity) {
+			lines_capacity *= 2;
+			map->lines = realloc(map->lines, sizeof(*map->lines) * lines_capacity);
+			assert(map->lines != NULL);
+		}
+
+		map_line_t *line = &map->lines[map->num_lines++];
+		line->chars = line_start;
+		line->length = (int)(line_end - line_start);
+		if (line->length > map->longest_line) {
+			map->longest_line = line->length;
+		}
+
+		line_start = next_line;
+	}
+}
+
+void Close_MapFile(map_file_t *map) {
+	assert(map != NULL);
+
+	if (map->data != NULL) {
+		munmap(map->data, map->size);
+	}
+	free(map->lines);
+	memset(map, 0, sizeof(*map));
+}
@@ -0,0 +1,36 @@
+#ifndef MAP_FILE_H_
+#define MAP_FILE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct map_line_t {
+	const char *chars;		// Points into the mapped file; not null-terminated.
+	int length;				// Number of characters, excluding the line ending.
+} map_line_t;
+
+typedef struct map_file_t {
+	char *data;				// Read-only mapping of the whole file (NULL if the file is empty).
+	size_t size;
+	map_line_t *lines;
+	int num_lines;
+	int longest_line;
+} map_file_t;
+
+/*
+	Memory-maps the map file 'filename' without looking for lines, so compiled binary maps are never scanned (txt maps then call 'Find_MapFileLines').
+	Returns false (leaving 'map' empty) if the file could not be opened or mapped.
+*/
+bool Open_MapFileData(map_file_t *map, const char *filename);
+
+/*
+	Finds the extents of every line in an already mapped file, and the longest line, in a single scan.
+*/
+void Find_MapFileLines(map_file_t *map);
+
+/*
+	Unmaps and frees all memory allocated from calling 'Open_MapFileData' and 'Find_MapFileLines'.
+*/
+void Close_MapFile(map_file_t *map);
+
+#endif // !MAP_FILE_H_
@@ -0,0 +1,151 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#include "pathfinder.h"
+
+/*
+	Returns true if heap entry 'a' should be expanded before 'b'.
+*/
+static bool Check_PathHeapBefore(const path_heap_entry_t *a, const path_heap_entry_t *b) {
+	return a->estimate < b->estimate || (a->estimate == b->estimate && a->heuristic < b->heuristic);
+}
+
+/*
+	Places 'entry' at heap position 'position', keeping its node's heap position current.
+*/
+static void Set_PathHeapEntry(pathfinder_t *pathfinder, int position, path_heap_entry_t entry) {
+	pathfinder->heap[position] = entry;
+	pathfinder->nodes[entry.node].heap_position = position;
+}
+
+/*
+	Moves the heap entry at 'position' towards the root until its parent comes before it.
+*/
+static void SiftUp_PathHeap(pathfinder_t *pathfinder, int position) {
+	const path_heap_entry_t entry = pathfinder->heap[position];
+	while (position > 0) {
+		const int parent = (position - 1) / 2;
+		if (!Check_PathHeapBefore(&entry, &pathfinder->heap[parent])) {
+			break;
+		}
+		Set_PathHeapEntry(pathfinder, position, pathfinder->heap[parent]);
+		position = parent;
+	}
+	Set_PathHeapEntry(pathfinder, position, entry);
+}
+
+/*
+	Moves the heap entry at 'position' towards the leaves until neither child comes before it.
+*/
+static void SiftDown_PathHeap(pathfinder_t *pathfinder, int position) {
+	const path_heap_entry_t entry = pathfinder->heap[position];
+	while (true) {
+		int child = (position * 2) + 1;
+		if (child >= pathfinder->heap_size) {
+			break;
+		}
+		if (child + 1 < pathfinder->heap_size && Check_PathHeapBefore(&pathfinder->heap[child + 1], &pathfinder->heap[child])) {
+			child++;
+		}
+		if (!Check_PathHeapBefore(&pathfinder->heap[child], &entry)) {
+			break;
+		}
+		Set_PathHeapEntry(pathfinder, position, pathfinder->heap[child]);
+		position = child;
+	}
+	Set_PathHeapEntry(pathfinder, position, entry);
+}
+
+size_t Get_PathfinderSize(int width, int height) {
+	assert(width >= 0 && height >= 0);
+
+	return Get_ArenaAllocSize(sizeof(path_node_t) * width * height)
+		+ Get_ArenaAllocSize(sizeof(path_heap_entry_t) * width * height)
+		+ Get_ArenaAllocSize(sizeof(coord_t) * width * height);
+}
+
+void Init_Pathfinder(pathfinder_t *pathfinder, arena_t *arena, int width, int height) {
+	assert(pathfinder != NULL);
+	assert(arena != NULL);
+	assert(width >= 0 && height >= 0);
+
+	pathfinder->width = width;
+	pathfinder->height = height;
+	pathfinder->nodes = Alloc_Arena(arena, sizeof(*pathfinder->nodes) * width * height);
+	pathfinder->heap = Alloc_Arena(arena, sizeof(*pathfinder->heap) * width * height);
+	pathfinder->path = Alloc_Arena(arena, sizeof(*pathfinder->path) * width * height);
+
+	// Generation 0 is never a query, so every node starts out unseen.
+	memset(pathfinder->nodes, 0, sizeof(*pathfinder->nodes) * width * height);
+	pathfinder->generation = 0;
+	pathfinder->heap_size = 0;
+	pathfinder->path_length = 0;
+	pathfinder->nodes_expanded = 0;
+	pathfinder->total_nodes_expanded = 0;
+	pathfinder->num_queries = 0;
+}
+
+void Begin_PathfinderQuery(pathfinder_t *pathfinder) {
+	assert(pathfinder != NULL);
+
+	// Only when the counter wraps around do the nodes need clearing, so stale generations can't match a new query.
+	if (++pathfinder->generation == 0) {
+		memset(pathfinder->nodes, 0, sizeof(*pathfinder->nodes) * pathfinder->width * pathfinder->height);
+		pathfinder->generation = 1;
+	}
+
+	pathfinder->heap_size = 0;
+	pathfinder->path_length = 0;
+	pathfinder->nodes_expanded = 0;
+	pathfinder->num_queries++;
+}
+
+path_node_t* Get_PathNode(pathfinder_t *pathfinder, int index) {
+	assert(pathfinder != NULL);
+	assert(index >= 0 && index < pathfinder->width * pathfinder->height);
+
+	path_node_t *node = &pathfinder->nodes[index];
+	if (node->generation != pathfinder->generation) {
+		node->generation = pathfinder->generation;
+		node->cost = INT_MAX;
+		node->parent = -1;
+		node->heap_position = PATH_NODE_UNSEEN;
+	}
+	return node;
+}
+
+void Push_PathHeap(pathfinder_t *pathfinder, int index, int estimate, int heuristic) {
+	assert(pathfinder != NULL);
+
+	const path_node_t *node = Get_PathNode(pathfinder, index);
+	assert(node->heap_position != PATH_NODE_CLOSED);
+
+	const path_heap_entry_t entry = {.estimate = estimate, .heuristic = heuristic, .node = index};
+	if (node->heap_position == PATH_NODE_UNSEEN) {
+		assert(pathfinder->heap_size < pathfinder->width * pathfinder->height);
+		pathfinder->heap[pathfinder->heap_size] = entry;
+		SiftUp_PathHeap(pathfinder, pathfinder->heap_size++);
+	} else {
+		// A cheaper path only ever lowers the estimate, so the entry can only move up.
+		pathfinder->heap[node->heap_position] = entry;
+		SiftUp_PathHeap(pathfinder, node->heap_position);
+	}
+}
+
+int Pop_PathHeap(pathfinder_t *pathfinder) {
+	assert(pathfinder != NULL);
+	assert(pathfinder->heap_size > 0);
+
+	const int index = pathfinder->heap[0].node;
+	pathfinder->nodes[index].heap_position = PATH_NODE_CLOSED;
+
+	if (--pathfinder->heap_size > 0) {
+		Set_PathHeapEntry(pathfinder, 0, pathfinder->heap[pathfinder->heap_size]);
+		SiftDown_PathHeap(pathfinder, 0);
+	}
+
+	pathfinder->nodes_expanded++;
+	pathfinder->total_nodes_expanded++;
+	return index;
+}
@@ -0,0 +1,69 @@
+#ifndef PATHFINDER_H_
+#define PATHFINDER_H_
+
+#include <stdbool.h>
+#include "coord.h"
+#include "arena.h"
+
+#define PATH_NOT_FOUND (-1)						// Path length returned when no path exists.
+#define PATH_NODE_UNSEEN (-1)					// Heap position of a node not yet reached by the current query.
+#define PATH_NODE_CLOSED (-2)					// Heap position of a node already expanded by the current query.
+
+typedef struct path_node_t {
+	unsigned int generation;	// Query that last touched the node. Nodes from older queries count as unseen, so the grid is never cleared between queries.
+	int cost;					// Steps from the start along the best path found so far.
+	int parent;					// Node index the best path arrives from.
+	int heap_position;			// Position in the open heap, or PATH_NODE_UNSEEN / PATH_NODE_CLOSED.
+} path_node_t;
+
+typedef struct path_heap_entry_t {
+	int estimate;				// Cost so far plus the heuristic to the goal.
+	int heuristic;				// Breaks ties in favour of nodes closer to the goal.
+	int node;
+} path_heap_entry_t;
+
+typedef struct pathfinder_t {
+	int width;
+	int height;
+	path_node_t *nodes;			// One node per grid cell, indexed x * height + y.
+	path_heap_entry_t *heap;	// Open set as a binary min-heap. Each node knows its heap position, so a cheaper path updates it in place.
+	int heap_size;
+	coord_t *path;				// Steps of the last path found, from the first step after the start to the goal.
+	int path_length;
+	unsigned int generation;	// Current query.
+	int nodes_expanded;			// Nodes taken from the open set by the last query.
+	long long total_nodes_expanded;
+	int num_queries;
+} pathfinder_t;
+
+/*
+	Returns the number of arena bytes taken by a pathfinder over a 'width' x 'height' grid.
+*/
+size_t Get_PathfinderSize(int width, int height);
+
+/*
+	Initialises a pathfinder over a 'width' x 'height' grid, allocating its nodes, heap and path from 'arena'. The storage is released with the arena.
+*/
+void Init_Pathfinder(pathfinder_t *pathfinder, arena_t *arena, int width, int height);
+
+/*
+	Starts a new query: every node becomes unseen, the open set empties and the per-query counter restarts, all without touching the nodes.
+*/
+void Begin_PathfinderQuery(pathfinder_t *pathfinder);
+
+/*
+	Returns the node at 'index', resetting it first if the current query hasn't seen it yet.
+*/
+path_node_t* Get_PathNode(pathfinder_t *pathfinder, int index);
+
+/*
+	Adds node 'index' to the open set with the given estimate, or moves it up the heap if it is already open.
+*/
+void Push_PathHeap(pathfinder_t *pathfinder, int index, int estimate, int heuristic);
+
+/*
+	Removes and returns the open node with the lowest estimate, marking it closed. The open set must not be empty.
+*/
+int Pop_PathHeap(pathfinder_t *pathfinder);
+
+#endif // !PATHFINDER_H_
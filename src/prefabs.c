@@ -0,0 +1,222 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <dirent.h>
+#include "prefabs.h"
+
+#define PREFAB_FILE_EXTENSION ".txt"
+
+/*
+	Returns the tile of a prefab's layout at (x, y).
+*/
+static const tile_t* Get_PrefabTile(const prefab_t *prefab, int x, int y) {
+	return &prefab->layout.tiles[(x * prefab->layout.height) + y];
+}
+
+/*
+	Returns true if 'filename' ends with the prefab file extension.
+*/
+static bool Check_PrefabFilename(const char *filename) {
+	const size_t length = strlen(filename);
+	const size_t extension_length = strlen(PREFAB_FILE_EXTENSION);
+	return length > extension_length && strcmp(filename + length - extension_length, PREFAB_FILE_EXTENSION) == 0;
+}
+
+/*
+	Sorts filenames alphabetically (used with qsort).
+*/
+static int Compare_Filenames(const void *a, const void *b) {
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/*
+	Works out a prefab's radius, doors and footprint from its layout. Returns false if the layout isn't a valid prefab room.
+*/
+static bool Init_Prefab(prefab_t *prefab) {
+	assert(prefab != NULL);
+
+	const map_template_t *layout = &prefab->layout;
+	if (layout->width != layout->height || layout->width % 2 == 0) {
+		return false;
+	}
+
+	prefab->radius = layout->width / 2;
+	if (prefab->radius < PREFAB_MIN_RADIUS || prefab->radius > PREFAB_MAX_RADIUS) {
+		return false;
+	}
+
+	// The center is where the player or staircase may be placed.
+	const int r = prefab->radius;
+	if (Get_PrefabTile(prefab, r, r)->data != GetTileData(TileSlug_GROUND)) {
+		return false;
+	}
+
+	// Each side's center (in direction_en order), and the tile just inside it.
+	const coord_t door_pos[4] = {NewCoord(r, 0), NewCoord(r, layout->height - 1), NewCoord(0, r), NewCoord(layout->width - 1, r)};
+	const coord_t inside_pos[4] = {NewCoord(r, 1), NewCoord(r, layout->height - 2), NewCoord(1, r), NewCoord(layout->width - 2, r)};
+
+	prefab->door_mask = 0;
+	for (int dir = 0; dir < 4; dir++) {
+		const tile_t *door = Get_PrefabTile(prefab, door_pos[dir].x, door_pos[dir].y);
+		const tile_t *inside = Get_PrefabTile(prefab, inside_pos[dir].x, inside_pos[dir].y);
+		if (door->data == GetTileData(TileSlug_OPENING) && inside->data->type != TileType_SOLID && inside->data != GetTileData(TileSlug_VOID)) {
+			prefab->door_mask |= (1u << dir);
+		}
+	}
+	if (prefab->door_mask == 0) {
+		return false;
+	}
+
+	// Each column must occupy a single unbroken span of rows, so it can be stamped with one copy.
+	memset(prefab->footprint_rows, 0, sizeof(prefab->footprint_rows));
+	for (int x = 0; x < layout->width; x++) {
+		int start = -1;
+		int end = -1;
+		for (int y = 0; y < layout->height; y++) {
+			if (Get_PrefabTile(prefab, x, y)->data == GetTileData(TileSlug_VOID)) {
+				continue;
+			}
+			if (start != -1 && end != y - 1) {
+				return false;
+			}
+
+			start = (start == -1) ? y : start;
+			end = y;
+			prefab->footprint_rows[y] |= ((uint32_t)1 << x);
+		}
+
+		prefab->column_start[x] = (start == -1) ? 0 : start;
+		prefab->column_length[x] = (start == -1) ? 0 : (end - start + 1);
+	}
+
+	return true;
+}
+
+bool Init_PrefabLibrary(prefab_library_t *library, const char *directory) {
+	assert(library != NULL);
+	assert(directory != NULL);
+
+	memset(library, 0, sizeof(*library));
+
+	DIR *dir = opendir(directory);
+	if (dir == NULL) {
+		return false;
+	}
+
+	// Collect and sort the filenames first, so the library's order never depends on the filesystem.
+	char **filenames = NULL;
+	int num_filenames = 0;
+	int filenames_capacity = 0;
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL) {
+		if (!Check_PrefabFilename(entry->d_name)) {
+			continue;
+		}
+
+		if (num_filenames == filenames_capacity) {
+			filenames_capacity = (filenames_capacity > 0) ? filenames_capacity * 2 : 16;
+			filenames = realloc(filenames, sizeof(*filenames) * filenames_capacity);
+			assert(filenames != NULL);
+		}
+
+		const size_t path_size = strlen(directory) + strlen(entry->d_name) + 2;
+		filenames[num_filenames] = malloc(path_size);
+		assert(filenames[num_filenames] != NULL);
+		snprintf(filenames[num_filenames], path_size, "%s/%s", directory, entry->d_name);
+		num_filenames++;
+	}
+	closedir(dir);
+
+	if (num_filenames > 0) {
+		qsort(filenames, num_filenames, sizeof(*filenames), Compare_Filenames);
+	}
+
+	library->prefabs = malloc(sizeof(*library->prefabs) * (num_filenames > 0 ? num_filenames : 1));
+	assert(library->prefabs != NULL);
+
+	for (int i = 0; i < num_filenames; i++) {
+		prefab_t *prefab = &library->prefabs[library->num_prefabs];
+		if (Init_MapTemplate(&prefab->layout, filenames[i])) {
+			if (Init_Prefab(prefab)) {
+				library->num_prefabs++;
+			} else {
+				Cleanup_MapTemplate(&prefab->layout);
+			}
+		}
+		free(filenames[i]);
+	}
+	free(filenames);
+
+	// Index the prefabs by radius and door mask (a counting sort, keeping filename order within each bucket).
+	library->bucket_prefabs = malloc(sizeof(*library->bucket_prefabs) * (library->num_prefabs > 0 ? library->num_prefabs : 1));
+	assert(library->bucket_prefabs != NULL);
+
+	for (int i = 0; i < library->num_prefabs; i++) {
+		library->bucket_count[library->prefabs[i].radius][library->prefabs[i].door_mask]++;
+	}
+
+	int next = 0;
+	for (int radius = 0; radius <= PREFAB_MAX_RADIUS; radius++) {
+		for (int mask = 0; mask < PREFAB_DOOR_MASKS; mask++) {
+			library->bucket_first[radius][mask] = next;
+			next += library->bucket_count[radius][mask];
+		}
+	}
+
+	int filled[PREFAB_MAX_RADIUS + 1][PREFAB_DOOR_MASKS] = {{0}};
+	for (int i = 0; i < library->num_prefabs; i++) {
+		const int radius = library->prefabs[i].radius;
+		const int mask = library->prefabs[i].door_mask;
+		library->bucket_prefabs[library->bucket_first[radius][mask] + filled[radius][mask]++] = i;
+	}
+
+	return true;
+}
+
+void Cleanup_PrefabLibrary(prefab_library_t *library) {
+	assert(library != NULL);
+
+	for (int i = 0; i < library->num_prefabs; i++) {
+		Cleanup_MapTemplate(&library->prefabs[i].layout);
+	}
+	free(library->prefabs);
+	free(library->bucket_prefabs);
+	memset(library, 0, sizeof(*library));
+}
+
+int Count_Prefabs(const prefab_library_t *library, int radius, unsigned int required_doors) {
+	assert(library != NULL);
+
+	if (radius < 0 || radius > PREFAB_MAX_RADIUS) {
+		return 0;
+	}
+
+	int count = 0;
+	for (unsigned int mask = 0; mask < PREFAB_DOOR_MASKS; mask++) {
+		if ((mask & required_doors) == required_doors) {
+			count += library->bucket_count[radius][mask];
+		}
+	}
+	return count;
+}
+
+const prefab_t* Get_Prefab(const prefab_library_t *library, int radius, unsigned int required_doors, int n) {
+	assert(library != NULL);
+	assert(radius >= 0 && radius <= PREFAB_MAX_RADIUS);
+	assert(n >= 0);
+
+	for (unsigned int mask = 0; mask < PREFAB_DOOR_MASKS; mask++) {
+		if ((mask & required_doors) != required_doors) {
+			continue;
+		}
+
+		if (n < library->bucket_count[radius][mask]) {
+			return &library->prefabs[library->bucket_prefabs[library->bucket_first[radius][mask] + n]];
+		}
+		n -= library->bucket_count[radius][mask];
+	}
+
+	assert(false);
+	return NULL;
+}
@@ -0,0 +1,54 @@
+#ifndef PREFABS_H_
+#define PREFABS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ascii_game.h"
+
+#define PREFAB_DIRECTORY "maps/prefabs"
+#define PREFAB_MIN_RADIUS 2
+#define PREFAB_MAX_RADIUS 7							// Matches the largest radius of a generated room.
+#define PREFAB_MAX_SIZE ((PREFAB_MAX_RADIUS * 2) + 1)
+#define PREFAB_DOOR_MASKS 16						// Every combination of the 4 directions.
+#define PREFAB_ROOM_CHANCE 35						// Percentage chance for each generated room to be replaced by a matching prefab.
+
+typedef struct prefab_t {
+	map_template_t layout;							// Tiles, items and enemy spawns of the room, including its walls.
+	int radius;										// The room is (radius * 2 + 1) tiles square, like a generated room.
+	unsigned int door_mask;							// Bit (1 << direction_en) is set for each side whose center can be opened to a corridor (marked '?').
+	uint32_t footprint_rows[PREFAB_MAX_SIZE];		// Bit x of row y is set if the room occupies (x, y), i.e. the tile isn't void.
+	int column_start[PREFAB_MAX_SIZE];				// First row each column occupies; void is only allowed above and below it.
+	int column_length[PREFAB_MAX_SIZE];				// Number of rows each column occupies.
+} prefab_t;
+
+typedef struct prefab_library_t {
+	prefab_t *prefabs;								// Sorted by filename, so seeded floors don't depend on directory order.
+	int num_prefabs;
+	int *bucket_prefabs;							// Prefab indices grouped by radius, then by door mask.
+	int bucket_first[PREFAB_MAX_RADIUS + 1][PREFAB_DOOR_MASKS];
+	int bucket_count[PREFAB_MAX_RADIUS + 1][PREFAB_DOOR_MASKS];
+} prefab_library_t;
+
+/*
+	Parses every txt map in 'directory' once into an indexed library of prefab rooms. Maps that aren't valid prefab rooms are skipped.
+	A valid prefab is a square of odd size with a walkable center, and at least one side center marked '?' as a door with a walkable tile behind it.
+	Returns false (leaving the library empty) if the directory could not be opened.
+*/
+bool Init_PrefabLibrary(prefab_library_t *library, const char *directory);
+
+/*
+	Frees all memory allocated from calling 'Init_PrefabLibrary'.
+*/
+void Cleanup_PrefabLibrary(prefab_library_t *library);
+
+/*
+	Returns the number of prefabs of 'radius' that have (at least) every door in 'required_doors'.
+*/
+int Count_Prefabs(const prefab_library_t *library, int radius, unsigned int required_doors);
+
+/*
+	Returns the 'n'th prefab of 'radius' that has (at least) every door in 'required_doors', where 'n' is less than the matching 'Count_Prefabs'.
+*/
+const prefab_t* Get_Prefab(const prefab_library_t *library, int radius, unsigned int required_doors, int n);
+
+#endif // !PREFABS_H_
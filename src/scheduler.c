@@ -0,0 +1,143 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "scheduler.h"
+
+/*
+	Returns true if heap entry 'a' acts before 'b'. Ties go to the lower actor, so the order never depends on the heap's history.
+*/
+static bool Check_SchedulerBefore(const scheduler_entry_t *a, const scheduler_entry_t *b) {
+	return a->time < b->time || (a->time == b->time && a->actor < b->actor);
+}
+
+/*
+	Places 'entry' at heap position 'position', keeping its actor's heap position current.
+*/
+static void Set_SchedulerEntry(scheduler_t *scheduler, int position, scheduler_entry_t entry) {
+	scheduler->heap[position] = entry;
+	scheduler->heap_positions[entry.actor] = position;
+}
+
+/*
+	Moves the heap entry at 'position' to its place, towards the root or the leaves.
+*/
+static void Sift_SchedulerEntry(scheduler_t *scheduler, int position) {
+	const scheduler_entry_t entry = scheduler->heap[position];
+
+	while (position > 0) {
+		const int parent = (position - 1) / 2;
+		if (!Check_SchedulerBefore(&entry, &scheduler->heap[parent])) {
+			break;
+		}
+		Set_SchedulerEntry(scheduler, position, scheduler->heap[parent]);
+		position = parent;
+	}
+
+	while (true) {
+		int child = (position * 2) + 1;
+		if (child >= scheduler->heap_size) {
+			break;
+		}
+		if (child + 1 < scheduler->heap_size && Check_SchedulerBefore(&scheduler->heap[child + 1], &scheduler->heap[child])) {
+			child++;
+		}
+		if (!Check_SchedulerBefore(&scheduler->heap[child], &entry)) {
+			break;
+		}
+		Set_SchedulerEntry(scheduler, position, scheduler->heap[child]);
+		position = child;
+	}
+
+	Set_SchedulerEntry(scheduler, position, entry);
+}
+
+/*
+	Removes the heap entry at 'position', filling the gap with the last entry.
+*/
+static void Remove_SchedulerEntry(scheduler_t *scheduler, int position) {
+	scheduler->heap_positions[scheduler->heap[position].actor] = SCHEDULER_NONE;
+
+	if (position != --scheduler->heap_size) {
+		scheduler->heap[position] = scheduler->heap[scheduler->heap_size];
+		Sift_SchedulerEntry(scheduler, position);
+	}
+}
+
+long long Get_ActionDelay(int speed) {
+	assert(speed > 0);
+
+	return ((long long)SCHEDULER_TURN_TIME * 100) / speed;
+}
+
+size_t Get_SchedulerSize(int capacity) {
+	assert(capacity >= 0);
+
+	return Get_ArenaAllocSize(sizeof(scheduler_entry_t) * capacity) + Get_ArenaAllocSize(sizeof(int) * capacity);
+}
+
+void Init_Scheduler(scheduler_t *scheduler, arena_t *arena, int capacity) {
+	assert(scheduler != NULL);
+	assert(arena != NULL);
+	assert(capacity >= 0);
+
+	scheduler->capacity = capacity;
+	scheduler->heap = Alloc_Arena(arena, sizeof(*scheduler->heap) * capacity);
+	scheduler->heap_positions = Alloc_Arena(arena, sizeof(*scheduler->heap_positions) * capacity);
+	for (int i = 0; i < capacity; i++) {
+		scheduler->heap_positions[i] = SCHEDULER_NONE;
+	}
+	scheduler->heap_size = 0;
+}
+
+void Reset_Scheduler(scheduler_t *scheduler) {
+	assert(scheduler != NULL);
+
+	// Only scheduled actors have a position to clear.
+	for (int i = 0; i < scheduler->heap_size; i++) {
+		scheduler->heap_positions[scheduler->heap[i].actor] = SCHEDULER_NONE;
+	}
+	scheduler->heap_size = 0;
+}
+
+void Schedule_Actor(scheduler_t *scheduler, int actor, long long time) {
+	assert(scheduler != NULL);
+	assert(actor >= 0 && actor < scheduler->capacity);
+
+	const scheduler_entry_t entry = {.time = time, .actor = actor};
+	int position = scheduler->heap_positions[actor];
+	if (position == SCHEDULER_NONE) {
+		position = scheduler->heap_size++;
+	}
+
+	scheduler->heap[position] = entry;
+	Sift_SchedulerEntry(scheduler, position);
+}
+
+void Unschedule_Actor(scheduler_t *scheduler, int actor) {
+	assert(scheduler != NULL);
+	assert(actor >= 0 && actor < scheduler->capacity);
+
+	if (scheduler->heap_positions[actor] != SCHEDULER_NONE) {
+		Remove_SchedulerEntry(scheduler, scheduler->heap_positions[actor]);
+	}
+}
+
+bool Check_ActorScheduled(const scheduler_t *scheduler, int actor) {
+	assert(scheduler != NULL);
+	assert(actor >= 0 && actor < scheduler->capacity);
+
+	return scheduler->heap_positions[actor] != SCHEDULER_NONE;
+}
+
+int Pop_DueActor(scheduler_t *scheduler, long long end_time, long long *time) {
+	assert(scheduler != NULL);
+	assert(time != NULL);
+
+	if (scheduler->heap_size == 0 || scheduler->heap[0].time >= end_time) {
+		return SCHEDULER_NONE;
+	}
+
+	const int actor = scheduler->heap[0].actor;
+	*time = scheduler->heap[0].time;
+	Remove_SchedulerEntry(scheduler, 0);
+	return actor;
+}
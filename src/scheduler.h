@@ -0,0 +1,62 @@
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <stdbool.h>
+#include "arena.h"
+
+#define SCHEDULER_NONE (-1)						// Actor returned when no actor is due, and heap position of unscheduled actors.
+#define SCHEDULER_TURN_TIME 100					// Time between the actions of an actor with speed 100.
+
+typedef struct scheduler_entry_t {
+	long long time;				// When the actor acts next.
+	int actor;
+} scheduler_entry_t;
+
+typedef struct scheduler_t {
+	scheduler_entry_t *heap;	// Scheduled actors as a binary min-heap, earliest (then lowest actor) first.
+	int *heap_positions;		// Position of each actor in 'heap', or SCHEDULER_NONE.
+	int heap_size;
+	int capacity;				// Actors are numbered from 0 to capacity - 1.
+} scheduler_t;
+
+/*
+	Returns the time between the actions of an actor with 'speed' (greater than 0). Faster actors act more often.
+*/
+long long Get_ActionDelay(int speed);
+
+/*
+	Returns the number of arena bytes taken by a scheduler for 'capacity' actors.
+*/
+size_t Get_SchedulerSize(int capacity);
+
+/*
+	Initialises an empty scheduler for actors 0 to 'capacity' - 1, allocating its storage from 'arena'. The storage is released with the arena.
+*/
+void Init_Scheduler(scheduler_t *scheduler, arena_t *arena, int capacity);
+
+/*
+	Unschedules every actor at once.
+*/
+void Reset_Scheduler(scheduler_t *scheduler);
+
+/*
+	Schedules 'actor' to act at 'time', moving it if it is already scheduled. O(log n).
+*/
+void Schedule_Actor(scheduler_t *scheduler, int actor, long long time);
+
+/*
+	Removes 'actor' from the schedule if it is scheduled. O(log n).
+*/
+void Unschedule_Actor(scheduler_t *scheduler, int actor);
+
+/*
+	Returns true if 'actor' is scheduled.
+*/
+bool Check_ActorScheduled(const scheduler_t *scheduler, int actor);
+
+/*
+	Removes and returns the earliest actor if it acts before 'end_time', or returns SCHEDULER_NONE. Its time is stored in 'time'. O(log n).
+*/
+int Pop_DueActor(scheduler_t *scheduler, long long end_time, long long *time);
+
+#endif // !SCHEDULER_H_
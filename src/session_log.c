@@ -0,0 +1,231 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include "session_log.h"
+
+/*
+	Returns the slot for the next record if the queue has room, or NULL (counting the record as dropped) if it is full. Game thread only.
+*/
+static session_record_t* Begin_SessionLogRecord(session_log_t *session_log, session_record_en kind) {
+	const unsigned int head = session_log->head;
+	const unsigned int tail = __atomic_load_n(&session_log->tail, __ATOMIC_ACQUIRE);
+	if (head - tail == (unsigned int)session_log->capacity) {
+		__atomic_store_n(&session_log->num_dropped, session_log->num_dropped + 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+	session_record_t *record = &session_log->records[head & (session_log->capacity - 1)];
+	record->kind = kind;
+	return record;
+}
+
+/*
+	Hands the slot returned by 'Begin_SessionLogRecord' over to the writer thread. Game thread only.
+*/
+static void Commit_SessionLogRecord(session_log_t *session_log) {
+	__atomic_store_n(&session_log->head, session_log->head + 1, __ATOMIC_RELEASE);
+}
+
+/*
+	Formats 'record' into 'line' as one line of text, and returns its length.
+*/
+static int Format_SessionLogRecord(const session_record_t *record, char *line) {
+	char text[LOG_BUFFER_SIZE];
+	int length = 0;
+
+	switch (record->kind) {
+		case SessionRecord_EVENT:
+			Format_GameLogEntry(&record->data.event, text);
+			length = snprintf(line, SESSION_LOG_LINE_SIZE, "%s\n", text);
+			break;
+		case SessionRecord_TEXT:
+			length = snprintf(line, SESSION_LOG_LINE_SIZE, "%s\n", record->data.text);
+			break;
+		case SessionRecord_TURN: {
+			const session_turn_t *turn = &record->data.turn;
+			length = snprintf(line, SESSION_LOG_LINE_SIZE, "-- turn %d, floor %d: health %d/%d, gold %d, at (%d, %d), %d enemies awake --\n",
+				turn->turn, turn->floor, turn->health, turn->max_health, turn->gold, turn->x, turn->y, turn->enemies_awake);
+			break;
+		}
+		default:
+			assert(false);
+	}
+
+	// snprintf returns the length the line would have had before any truncation.
+	return (length < SESSION_LOG_LINE_SIZE) ? length : SESSION_LOG_LINE_SIZE - 1;
+}
+
+/*
+	Notes in the batch how many more records have been dropped since it was last noted, and returns the length of the note (0 if there were none). Writer thread only.
+*/
+static int Format_SessionLogDropped(session_log_t *session_log, char *line) {
+	const unsigned int num_dropped = __atomic_load_n(&session_log->num_dropped, __ATOMIC_RELAXED);
+	if (num_dropped == session_log->num_reported) {
+		return 0;
+	}
+
+	const int length = snprintf(line, SESSION_LOG_LINE_SIZE, "-- %u records dropped: the session log fell behind --\n", num_dropped - session_log->num_reported);
+	session_log->num_reported = num_dropped;
+	// snprintf returns the length the line would have had before any truncation.
+	return (length < SESSION_LOG_LINE_SIZE) ? length : SESSION_LOG_LINE_SIZE - 1;
+}
+
+/*
+	Writes all 'length' bytes of 'buffer' to the file, retrying after partial writes and interruptions. Gives up on any other error, as there is nobody to report it to.
+*/
+static void Write_SessionLogBatch(int fd, const char *buffer, size_t length) {
+	while (length > 0) {
+		const ssize_t written = write(fd, buffer, length);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return;
+		}
+		buffer += written;
+		length -= (size_t)written;
+	}
+}
+
+/*
+	Writer thread loop: formats up to SESSION_LOG_BATCH_SIZE waiting records at a time into one write() call, sleeping whenever the queue is empty,
+	until the log shuts down with nothing left to drain. The sleep backs off while the queue stays empty (e.g. while the game waits for a key),
+	so an idle game wakes the writer only a few times a second, and the game thread never has to signal it.
+*/
+static void* Run_SessionLogWriter(void *arg) {
+	session_log_t *session_log = arg;
+	long idle_nsec = SESSION_LOG_IDLE_MIN_NSEC;
+
+	while (true) {
+		// Checked before the queue, so every record pushed before the shutdown is seen below.
+		const bool shutting_down = __atomic_load_n(&session_log->shutting_down, __ATOMIC_ACQUIRE);
+		const unsigned int head = __atomic_load_n(&session_log->head, __ATOMIC_ACQUIRE);
+		unsigned int tail = session_log->tail;
+
+		size_t length = Format_SessionLogDropped(session_log, session_log->batch);
+		for (int i = 0; i < SESSION_LOG_BATCH_SIZE && tail != head; i++, tail++) {
+			length += Format_SessionLogRecord(&session_log->records[tail & (session_log->capacity - 1)], session_log->batch + length);
+		}
+
+		// The slots are free again as soon as they have been formatted, before the write itself.
+		const bool drained_any = (tail != session_log->tail);
+		__atomic_store_n(&session_log->tail, tail, __ATOMIC_RELEASE);
+		Write_SessionLogBatch(session_log->fd, session_log->batch, length);
+
+		if (tail == head) {
+			if (shutting_down) {
+				break;
+			}
+
+			idle_nsec = drained_any ? SESSION_LOG_IDLE_MIN_NSEC : ((idle_nsec * 2 < SESSION_LOG_IDLE_MAX_NSEC) ? idle_nsec * 2 : SESSION_LOG_IDLE_MAX_NSEC);
+			const struct timespec idle = { .tv_sec = 0, .tv_nsec = idle_nsec };
+			nanosleep(&idle, NULL);
+		}
+	}
+
+	// Records dropped after the last batch.
+	const int length = Format_SessionLogDropped(session_log, session_log->batch);
+	Write_SessionLogBatch(session_log->fd, session_log->batch, length);
+
+	return NULL;
+}
+
+bool Init_SessionLog(session_log_t *session_log, const char *filename, int capacity) {
+	assert(session_log != NULL);
+	assert(filename != NULL);
+	assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+
+	session_log->fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (session_log->fd < 0) {
+		return false;
+	}
+
+	session_log->records = malloc(sizeof(*session_log->records) * capacity);
+	assert(session_log->records != NULL);
+	session_log->capacity = capacity;
+
+	// Room for every record of a batch, plus the note of any dropped before it.
+	session_log->batch = malloc(sizeof(*session_log->batch) * SESSION_LOG_LINE_SIZE * (SESSION_LOG_BATCH_SIZE + 1));
+	assert(session_log->batch != NULL);
+
+	session_log->head = 0;
+	session_log->tail = 0;
+	session_log->num_dropped = 0;
+	session_log->num_reported = 0;
+	session_log->shutting_down = false;
+
+	if (pthread_create(&session_log->writer, NULL, Run_SessionLogWriter, session_log) != 0) {
+		free(session_log->records);
+		session_log->records = NULL;
+		free(session_log->batch);
+		session_log->batch = NULL;
+		close(session_log->fd);
+		session_log->fd = -1;
+		return false;
+	}
+	return true;
+}
+
+void Cleanup_SessionLog(session_log_t *session_log) {
+	assert(session_log != NULL);
+
+	__atomic_store_n(&session_log->shutting_down, true, __ATOMIC_RELEASE);
+	pthread_join(session_log->writer, NULL);
+
+	close(session_log->fd);
+	session_log->fd = -1;
+	free(session_log->records);
+	session_log->records = NULL;
+	free(session_log->batch);
+	session_log->batch = NULL;
+}
+
+bool Push_SessionLogEvent(session_log_t *session_log, const log_entry_t *entry) {
+	assert(session_log != NULL);
+	assert(entry != NULL);
+
+	session_record_t *record = Begin_SessionLogRecord(session_log, SessionRecord_EVENT);
+	if (record == NULL) {
+		return false;
+	}
+	record->data.event = *entry;
+	Commit_SessionLogRecord(session_log);
+	return true;
+}
+
+bool Push_SessionLogText(session_log_t *session_log, const char *text) {
+	assert(session_log != NULL);
+	assert(text != NULL);
+
+	session_record_t *record = Begin_SessionLogRecord(session_log, SessionRecord_TEXT);
+	if (record == NULL) {
+		return false;
+	}
+	snprintf(record->data.text, LOG_BUFFER_SIZE, "%s", text);
+	Commit_SessionLogRecord(session_log);
+	return true;
+}
+
+bool Push_SessionLogTurn(session_log_t *session_log, const session_turn_t *turn) {
+	assert(session_log != NULL);
+	assert(turn != NULL);
+
+	session_record_t *record = Begin_SessionLogRecord(session_log, SessionRecord_TURN);
+	if (record == NULL) {
+		return false;
+	}
+	record->data.turn = *turn;
+	Commit_SessionLogRecord(session_log);
+	return true;
+}
+
+unsigned int Get_SessionLogDropped(const session_log_t *session_log) {
+	assert(session_log != NULL);
+
+	return __atomic_load_n(&session_log->num_dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,90 @@
+#ifndef SESSION_LOG_H_
+#define SESSION_LOG_H_
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "game_log.h"
+
+#define SESSION_LOG_CAPACITY 1024			// Records the session log's queue holds before new ones are dropped. Must be a power of 2.
+#define SESSION_LOG_BATCH_SIZE 64			// Most records the writer thread formats into one write() call.
+#define SESSION_LOG_LINE_SIZE (LOG_BUFFER_SIZE + 64)
+#define SESSION_LOG_IDLE_MIN_NSEC 1000000		// How long the writer thread first sleeps on finding the queue empty.
+#define SESSION_LOG_IDLE_MAX_NSEC 250000000		// Longest the writer thread sleeps, after the sleep doubles on every check that finds the queue still empty.
+
+typedef enum session_record_en {
+	SessionRecord_EVENT,		// A game log event, formatted by the writer thread.
+	SessionRecord_TEXT,			// A line of free text, already formatted.
+	SessionRecord_TURN,			// A summary of the end of a turn.
+} session_record_en;
+
+typedef struct session_turn_t {
+	int turn;
+	int floor;
+	int health;
+	int max_health;
+	int gold;
+	int x, y;
+	int enemies_awake;
+} session_turn_t;
+
+typedef struct session_record_t {
+	session_record_en kind;
+	union {
+		log_entry_t event;
+		char text[LOG_BUFFER_SIZE];
+		session_turn_t turn;
+	} data;
+} session_record_t;
+
+/*
+	A log of the whole session written to a file, for post-mortems. The game thread pushes records onto a bounded single-producer single-consumer queue
+	without ever taking a lock or touching the disk, and a writer thread drains them in batches, formatting each batch into a single write() call.
+	When the queue is full the newest record is dropped rather than waited on; how many were dropped is written to the file in their place.
+*/
+typedef struct session_log_t {
+	int fd;
+	pthread_t writer;
+	session_record_t *records;		// Ring buffer of 'capacity' records, indexed by 'head' and 'tail' modulo 'capacity'.
+	int capacity;
+	char *batch;					// The writer thread's buffer of formatted lines for its next write() call.
+
+	// Only the game thread writes 'head' and 'num_dropped', and only the writer thread writes 'tail'; each is read by the other thread with acquire/release atomics.
+	unsigned int head;				// Records ever pushed. The next record is pushed into slot 'head' % 'capacity'.
+	unsigned int tail;				// Records ever drained. 'head' - 'tail' records are waiting.
+	unsigned int num_dropped;		// Records dropped because the queue was full.
+	unsigned int num_reported;		// Dropped records already noted in the file (writer thread only).
+	bool shutting_down;
+} session_log_t;
+
+/*
+	Creates (or truncates) the file at 'filename' and starts the writer thread, with room for 'capacity' queued records (a power of 2).
+	Returns false, leaving nothing to clean up, if the file can't be opened or the writer thread can't be started.
+*/
+bool Init_SessionLog(session_log_t *session_log, const char *filename, int capacity);
+
+/*
+	Waits for the writer thread to drain every record pushed so far, then stops it and closes the file.
+*/
+void Cleanup_SessionLog(session_log_t *session_log);
+
+/*
+	Pushes a game log event, formatted on the writer thread. Returns false if the queue was full and the event was dropped. Never blocks.
+*/
+bool Push_SessionLogEvent(session_log_t *session_log, const log_entry_t *entry);
+
+/*
+	Pushes a line of already formatted text. Returns false if the queue was full and the line was dropped. Never blocks.
+*/
+bool Push_SessionLogText(session_log_t *session_log, const char *text);
+
+/*
+	Pushes the summary of a turn. Returns false if the queue was full and the summary was dropped. Never blocks.
+*/
+bool Push_SessionLogTurn(session_log_t *session_log, const session_turn_t *turn);
+
+/*
+	Returns how many records have been dropped so far because the queue was full.
+*/
+unsigned int Get_SessionLogDropped(const session_log_t *session_log);
+
+#endif // !SESSION_LOG_H_
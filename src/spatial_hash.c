@@ -0,0 +1,196 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "spatial_hash.h"
+#include "ascii_game.h"
+
+/*
+	Returns the number of cells needed to cover 'length' tiles.
+*/
+static int Get_SpatialCellCount(int length) {
+	return (length + SPATIAL_CELL_SIZE - 1) / SPATIAL_CELL_SIZE;
+}
+
+/*
+	Returns true if 'tile' (x * height + y) lies within 'min' to 'max' (inclusive) and, for a radius of 0 or more, within 'radius' of 'center'.
+*/
+static bool Check_SpatialTileInRange(const spatial_hash_t *hash, int tile, coord_t min, coord_t max, coord_t center, int radius) {
+	const int x = tile / hash->height;
+	const int y = tile % hash->height;
+	if (x < min.x || x > max.x || y < min.y || y > max.y) {
+		return false;
+	}
+	return radius < 0 || ((x - center.x) * (x - center.x)) + ((y - center.y) * (y - center.y)) <= radius * radius;
+}
+
+/*
+	Stores up to 'max_results' listed tiles from 'min' to 'max' (and within 'radius' of 'center', unless 'radius' is negative) in 'results'.
+*/
+static int Query_SpatialHashCells(const spatial_hash_t *hash, coord_t min, coord_t max, coord_t center, int radius, int *results, int max_results) {
+	if (hash->num_listed == 0 || min.x > max.x || min.y > max.y || max.x < 0 || max.y < 0 || min.x >= hash->width || min.y >= hash->height) {
+		return 0;
+	}
+
+	const int min_cell_x = CLAMP(min.x, 0, hash->width - 1) / SPATIAL_CELL_SIZE;
+	const int min_cell_y = CLAMP(min.y, 0, hash->height - 1) / SPATIAL_CELL_SIZE;
+	const int max_cell_x = CLAMP(max.x, 0, hash->width - 1) / SPATIAL_CELL_SIZE;
+	const int max_cell_y = CLAMP(max.y, 0, hash->height - 1) / SPATIAL_CELL_SIZE;
+
+	int num_results = 0;
+	for (int cell_x = min_cell_x; cell_x <= max_cell_x; cell_x++) {
+		for (int cell_y = min_cell_y; cell_y <= max_cell_y; cell_y++) {
+			for (int tile = hash->cell_heads[(cell_x * hash->cells_h) + cell_y]; tile != SPATIAL_NONE; tile = hash->tile_next[tile]) {
+				if (!Check_SpatialTileInRange(hash, tile, min, max, center, radius)) {
+					continue;
+				}
+				if (num_results == max_results) {
+					return num_results;
+				}
+				results[num_results++] = tile;
+			}
+		}
+	}
+	return num_results;
+}
+
+size_t Get_SpatialHashSize(int width, int height) {
+	assert(width >= 0 && height >= 0);
+
+	return Get_ArenaAllocSize(sizeof(int) * Get_SpatialCellCount(width) * Get_SpatialCellCount(height))
+		+ (Get_ArenaAllocSize(sizeof(int) * width * height) * 3);
+}
+
+void Init_SpatialHash(spatial_hash_t *hash, arena_t *arena, int width, int height) {
+	assert(hash != NULL);
+	assert(arena != NULL);
+	assert(width >= 0 && height >= 0);
+
+	hash->width = width;
+	hash->height = height;
+	hash->cells_w = Get_SpatialCellCount(width);
+	hash->cells_h = Get_SpatialCellCount(height);
+	hash->cell_heads = Alloc_Arena(arena, sizeof(*hash->cell_heads) * hash->cells_w * hash->cells_h);
+	hash->tile_next = Alloc_Arena(arena, sizeof(*hash->tile_next) * width * height);
+	hash->tile_prev = Alloc_Arena(arena, sizeof(*hash->tile_prev) * width * height);
+	hash->tile_cells = Alloc_Arena(arena, sizeof(*hash->tile_cells) * width * height);
+	hash->num_listed = 0;
+
+	// All bytes set gives SPATIAL_NONE for every cell head and tile.
+	memset(hash->cell_heads, 0xFF, sizeof(*hash->cell_heads) * hash->cells_w * hash->cells_h);
+	memset(hash->tile_cells, 0xFF, sizeof(*hash->tile_cells) * width * height);
+}
+
+void Set_SpatialHashTile(spatial_hash_t *hash, coord_t pos, bool listed) {
+	assert(hash != NULL);
+	assert(pos.x >= 0 && pos.x < hash->width);
+	assert(pos.y >= 0 && pos.y < hash->height);
+
+	const int tile = (pos.x * hash->height) + pos.y;
+	if (listed == (hash->tile_cells[tile] != SPATIAL_NONE)) {
+		return;
+	}
+
+	if (listed) {
+		const int cell = ((pos.x / SPATIAL_CELL_SIZE) * hash->cells_h) + (pos.y / SPATIAL_CELL_SIZE);
+		hash->tile_cells[tile] = cell;
+		hash->tile_prev[tile] = SPATIAL_NONE;
+		hash->tile_next[tile] = hash->cell_heads[cell];
+		if (hash->cell_heads[cell] != SPATIAL_NONE) {
+			hash->tile_prev[hash->cell_heads[cell]] = tile;
+		}
+		hash->cell_heads[cell] = tile;
+		hash->num_listed++;
+	} else {
+		const int next = hash->tile_next[tile];
+		const int prev = hash->tile_prev[tile];
+		if (prev != SPATIAL_NONE) {
+			hash->tile_next[prev] = next;
+		} else {
+			hash->cell_heads[hash->tile_cells[tile]] = next;
+		}
+		if (next != SPATIAL_NONE) {
+			hash->tile_prev[next] = prev;
+		}
+		hash->tile_cells[tile] = SPATIAL_NONE;
+		hash->num_listed--;
+	}
+}
+
+bool Check_SpatialHashTile(const spatial_hash_t *hash, coord_t pos) {
+	assert(hash != NULL);
+	assert(pos.x >= 0 && pos.x < hash->width);
+	assert(pos.y >= 0 && pos.y < hash->height);
+
+	return hash->tile_cells[(pos.x * hash->height) + pos.y] != SPATIAL_NONE;
+}
+
+int Query_SpatialHashRect(const spatial_hash_t *hash, coord_t min, coord_t max, int *results, int max_results) {
+	assert(hash != NULL);
+	assert(results != NULL || max_results == 0);
+
+	return Query_SpatialHashCells(hash, min, max, min, -1, results, max_results);
+}
+
+int Query_SpatialHashRadius(const spatial_hash_t *hash, coord_t center, int radius, int *results, int max_results) {
+	assert(hash != NULL);
+	assert(results != NULL || max_results == 0);
+	assert(radius >= 0);
+
+	const coord_t min = NewCoord(center.x - radius, center.y - radius);
+	const coord_t max = NewCoord(center.x + radius, center.y + radius);
+	return Query_SpatialHashCells(hash, min, max, center, radius, results, max_results);
+}
+
+bool Find_SpatialHashNearest(const spatial_hash_t *hash, coord_t center, int max_distance, coord_t *nearest) {
+	assert(hash != NULL);
+	assert(nearest != NULL);
+	assert(max_distance >= 0);
+
+	if (hash->num_listed == 0 || hash->cells_w == 0 || hash->cells_h == 0) {
+		return false;
+	}
+
+	const int center_cell_x = CLAMP(center.x, 0, hash->width - 1) / SPATIAL_CELL_SIZE;
+	const int center_cell_y = CLAMP(center.y, 0, hash->height - 1) / SPATIAL_CELL_SIZE;
+	const int max_ring = (hash->cells_w > hash->cells_h) ? hash->cells_w : hash->cells_h;
+
+	int best_tile = SPATIAL_NONE;
+	int best_distance = max_distance + 1;
+	for (int ring = 0; ring <= max_ring; ring++) {
+		// Every tile in a cell 'ring' cells away is at least this many steps away, so once it passes the best found, no closer tile remains.
+		const int ring_distance = (ring == 0) ? 0 : ((ring - 1) * SPATIAL_CELL_SIZE) + 1;
+		if (ring_distance > best_distance || ring_distance > max_distance) {
+			break;
+		}
+
+		for (int cell_x = center_cell_x - ring; cell_x <= center_cell_x + ring; cell_x++) {
+			if (cell_x < 0 || cell_x >= hash->cells_w) {
+				continue;
+			}
+
+			// Inside the ring's left and right columns, only its top and bottom cells are on the ring.
+			const bool edge_column = (cell_x == center_cell_x - ring || cell_x == center_cell_x + ring);
+			const int cell_y_step = (edge_column || ring == 0) ? 1 : ring * 2;
+			for (int cell_y = center_cell_y - ring; cell_y <= center_cell_y + ring; cell_y += cell_y_step) {
+				if (cell_y < 0 || cell_y >= hash->cells_h) {
+					continue;
+				}
+
+				for (int tile = hash->cell_heads[(cell_x * hash->cells_h) + cell_y]; tile != SPATIAL_NONE; tile = hash->tile_next[tile]) {
+					const int distance = abs((tile / hash->height) - center.x) + abs((tile % hash->height) - center.y);
+					if (distance < best_distance || (distance == best_distance && tile < best_tile)) {
+						best_distance = distance;
+						best_tile = tile;
+					}
+				}
+			}
+		}
+	}
+
+	if (best_tile == SPATIAL_NONE) {
+		return false;
+	}
+
+	*nearest = NewCoord(best_tile / hash->height, best_tile % hash->height);
+	return true;
+}
@@ -0,0 +1,61 @@
+#ifndef SPATIAL_HASH_H_
+#define SPATIAL_HASH_H_
+
+#include <stdbool.h>
+#include "coord.h"
+#include "arena.h"
+
+#define SPATIAL_CELL_SIZE 8						// Width and height in tiles of each cell of the grid.
+#define SPATIAL_NONE (-1)						// Tile index of no tile, and cell of a tile that isn't listed.
+
+typedef struct spatial_hash_t {
+	int width;					// Size of the indexed area, in tiles.
+	int height;
+	int cells_w;
+	int cells_h;
+	int *cell_heads;			// First listed tile in each cell (indexed cell x * cells_h + cell y), or SPATIAL_NONE.
+	int *tile_next;				// Next listed tile in the same cell, for each tile (indexed x * height + y).
+	int *tile_prev;				// Previous listed tile in the same cell, or SPATIAL_NONE for the cell's first.
+	int *tile_cells;			// Cell each tile is listed in, or SPATIAL_NONE.
+	int num_listed;
+} spatial_hash_t;
+
+/*
+	Returns the number of arena bytes taken by a spatial hash over a 'width' x 'height' area.
+*/
+size_t Get_SpatialHashSize(int width, int height);
+
+/*
+	Initialises an empty spatial hash over a 'width' x 'height' area, allocating its storage from 'arena'. The storage is released with the arena.
+*/
+void Init_SpatialHash(spatial_hash_t *hash, arena_t *arena, int width, int height);
+
+/*
+	Lists or unlists the tile at 'pos'. Listing a listed tile (or unlisting an unlisted one) changes nothing. O(1).
+*/
+void Set_SpatialHashTile(spatial_hash_t *hash, coord_t pos, bool listed);
+
+/*
+	Returns true if the tile at 'pos' is listed.
+*/
+bool Check_SpatialHashTile(const spatial_hash_t *hash, coord_t pos);
+
+/*
+	Stores the tile indices (x * height + y) of up to 'max_results' listed tiles from 'min' to 'max' (inclusive) in 'results', and returns how many were stored.
+	Only the cells overlapping the rectangle are visited.
+*/
+int Query_SpatialHashRect(const spatial_hash_t *hash, coord_t min, coord_t max, int *results, int max_results);
+
+/*
+	Stores the tile indices (x * height + y) of up to 'max_results' listed tiles within 'radius' (by straight-line distance) of 'center' in 'results',
+	and returns how many were stored.
+*/
+int Query_SpatialHashRadius(const spatial_hash_t *hash, coord_t center, int radius, int *results, int max_results);
+
+/*
+	Finds the listed tile closest to 'center' by steps in the four directions (ties going to the lowest tile index), no more than 'max_distance' steps away.
+	Visits cells in rings outwards from 'center', stopping once no closer tile can remain. Returns false if there is none.
+*/
+bool Find_SpatialHashNearest(const spatial_hash_t *hash, coord_t center, int max_distance, coord_t *nearest);
+
+#endif // !SPATIAL_HASH_H_
@@ -2,10 +2,17 @@
 #include <stdlib.h>
 #include <curses.h>
 #include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "../ascii_game.h"
 #include "../george_graphics.h"
 #include "../log_messages.h"
+#include "../bitgrid.h"
+#include "../map_file.h"
+#include "../prefabs.h"
+#include "../field_of_view.h"
+#include "../session_log.h"
 #include "minunit.h"
 
 typedef struct floor_statistics_t {
@@ -27,6 +34,7 @@ static game_state_t Setup_Test_GameStateAndPlayer();
 static void Cleanup_Test_GameStateAndPlayer(game_state_t *state);
 static game_state_t Setup_Test_GameStatePlayerAndDungeon();
 static void Cleanup_Test_GameStatePlayerAndDungeon(game_state_t *state);
+static void Run_Test_CrowdedEnemyTurns(thread_pool_t *enemy_planners, unsigned long long *hashes, int num_turns);
 
 /*
 Setup before any tests.
@@ -79,7 +87,7 @@ static game_state_t Setup_Test_GameStatePlayerAndDungeon() {
 	Init_GameState(&state);
 	last_seed_used = state.debug_seed;
 	state.player = Create_Player();
-	InitCreate_DungeonFloor(&state, 10, NULL);
+	InitCreate_DungeonFloor(&state, 10, FloorLayout_ROOMS, NULL);
 	return state;
 }
 
@@ -91,6 +99,47 @@ static void Cleanup_Test_GameStatePlayerAndDungeon(game_state_t *state) {
 	Cleanup_GameState(state);
 }
 
+/*
+Runs 'num_turns' world turns of a floor crowded with enemies (the same floor every call), planning enemy actions across 'enemy_planners',
+and records the game state's hash after each turn.
+*/
+static void Run_Test_CrowdedEnemyTurns(thread_pool_t *enemy_planners, unsigned long long *hashes, int num_turns) {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	Seed_GameState(&state, 1234);
+	state.enemy_planners = enemy_planners;
+	state.player.stats.max_vision = 1000000;
+	state.player.stats.curr_health = 1000000;
+
+	// Open ground with scattered walls, and a crowd of enemies spread over it.
+	unsigned int layout_seed = 1234;
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+	for (int x = 1; x < world_screen_w - 1; x++) {
+		for (int y = 1; y < world_screen_h - 1; y++) {
+			const bool wall = (rand_r(&layout_seed) % 8) == 0;
+			Update_WorldTile(&state, NewCoord(x, y), GetTileData(wall ? TileSlug_WALL : TileSlug_GROUND));
+		}
+	}
+	state.player.pos = NewCoord(world_screen_w / 2, world_screen_h / 2);
+	Update_WorldTile(&state, state.player.pos, GetTileData(TileSlug_GROUND));
+
+	for (int i = 0; i < 1500; i++) {
+		const coord_t pos = NewCoord(1 + (rand_r(&layout_seed) % (world_screen_w - 2)), 1 + (rand_r(&layout_seed) % (world_screen_h - 2)));
+		if (!CoordsEqual(pos, state.player.pos) && Check_EnemyWalkable(&state.world_tiles[pos.x][pos.y]) && state.world_tiles[pos.x][pos.y].enemy_occupier == ENEMY_NONE) {
+			Spawn_Enemy(&state, GetEnemyData((i % 2 == 0) ? EnmySlug_ZOMBIE : EnmySlug_WEREWOLF), pos);
+		}
+	}
+
+	for (int turn = 0; turn < num_turns; turn++) {
+		Update_ActiveRegion(&state);
+		Update_FlowField(&state);
+		Update_EnemyTurns(&state);
+		hashes[turn] = Hash_GameState(&state);
+	}
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+}
+
 /*
 Compare all values of a world tile at position 'pos_to_assert'.
 */
@@ -108,7 +157,7 @@ static bool WorldTile_Item_IsEqualTo(game_state_t *state, coord_t pos_to_assert,
 /*
 Compare the world tile enemy occupier at position 'pos_to_assert'.
 */
-static bool WorldTile_Enemy_IsEqualTo(game_state_t *state, coord_t pos_to_assert, enemy_t *enemy_occupier) {
+static bool WorldTile_Enemy_IsEqualTo(game_state_t *state, coord_t pos_to_assert, int enemy_occupier) {
 	return state->world_tiles[pos_to_assert.x][pos_to_assert.y].enemy_occupier == enemy_occupier;
 }
 
@@ -130,8 +179,10 @@ int test_init_game_state_correct_values() {
 	mu_assert(__func__, state.debug_rcs == 0);
 	mu_assert(__func__, state.debug_seed > -1);
 	mu_assert(__func__, state.debug_injected_input_pos == 0);
-	mu_assert(__func__, state.enemy_list == (enemy_node_t*)NULL);
+	mu_assert(__func__, state.enemy_pool.num_slots == 0 && state.enemy_pool.num_free_slots == 0);
 	mu_assert(__func__, state.rooms == (room_t*)NULL);
+	mu_assert(__func__, state.regenerate_unreachable_floors == true);
+	mu_assert(__func__, CoordsEqual(state.staircase_pos, NewCoord(-1, -1)));
 
 	for (int i = 0; i < DEBUG_INJECTED_INPUT_LIMIT + 1; i++) {
 		mu_assert(__func__, state.debug_injected_inputs[i] == '\0');
@@ -149,15 +200,15 @@ int test_init_game_state_correct_values() {
 			coord_t coord = NewCoord(x, y);
 			mu_assert(__func__, WorldTile_IsEqualTo(&state, coord, GetTileData(TileSlug_VOID)) == true);
 			mu_assert(__func__, WorldTile_Item_IsEqualTo(&state, coord, NULL) == true);
-			mu_assert(__func__, WorldTile_Enemy_IsEqualTo(&state, coord, NULL) == true);
+			mu_assert(__func__, WorldTile_Enemy_IsEqualTo(&state, coord, ENEMY_NONE) == true);
 		}
 	}
 
-	mu_assert(__func__, strcmp(state.game_log.line1, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line2, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line3, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line4, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line5, " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 1), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), " ") == 0);
 
 	Cleanup_GameState(&state);
 	return 0;
@@ -180,6 +231,7 @@ int test_create_player_correct_values() {
 	mu_assert(__func__, player.stats.max_mana > 0);
 	mu_assert(__func__, player.stats.curr_mana == player.stats.max_mana);
 	mu_assert(__func__, player.stats.max_vision == PLAYER_MAX_VISION);
+	mu_assert(__func__, player.stats.speed == PLAYER_SPEED);
 	mu_assert(__func__, player.stats.s_str == 1);
 	mu_assert(__func__, player.stats.s_def == 1);
 	mu_assert(__func__, player.stats.s_vit == 1);
@@ -193,16 +245,14 @@ int test_create_player_correct_values() {
 
 int test_init_create_enemy_correct_values() {
 	coord_t pos = NewCoord(10, 10);
-	enemy_t* test_enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_ZOMBIE), pos);
+	enemy_t test_enemy = Create_Enemy(GetEnemyData(EnmySlug_ZOMBIE), pos);
 
-	mu_assert(__func__, test_enemy != NULL);
-	mu_assert(__func__, test_enemy->data == GetEnemyData(EnmySlug_ZOMBIE));
-	mu_assert(__func__, test_enemy->curr_health == GetEnemyData(EnmySlug_ZOMBIE)->max_health);
-	mu_assert(__func__, CoordsEqual(test_enemy->pos, pos));
-	mu_assert(__func__, test_enemy->is_alive == true);
-	mu_assert(__func__, test_enemy->loot != NULL);
+	mu_assert(__func__, test_enemy.data == GetEnemyData(EnmySlug_ZOMBIE));
+	mu_assert(__func__, test_enemy.curr_health == GetEnemyData(EnmySlug_ZOMBIE)->max_health);
+	mu_assert(__func__, CoordsEqual(test_enemy.pos, pos));
+	mu_assert(__func__, test_enemy.is_alive == true);
+	mu_assert(__func__, test_enemy.loot != NULL);
 
-	free(test_enemy);
 	return 0;
 }
 
@@ -253,6 +303,1063 @@ int test_created_dungeon_floor_contains_player() {
 	return 0;
 }
 
+int test_created_cave_floor_contains_staircase_and_player() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	InitCreate_DungeonFloor(&state, 10, FloorLayout_CAVE, NULL);
+
+	mu_assert(__func__, state.num_rooms_created == 10);
+
+	// The staircase is placed at the center of the last room, which must be open cavern.
+	room_t staircase_room = state.rooms[state.num_rooms_created - 1];
+	coord_t staircase_pos = NewCoord((staircase_room.TL_corner.x + staircase_room.TR_corner.x) / 2, (staircase_room.TL_corner.y + staircase_room.BL_corner.y) / 2);
+	mu_assert(__func__, state.world_tiles[staircase_pos.x][staircase_pos.y].data->sprite == SPR_STAIRCASE);
+
+	mu_assert(__func__, CoordsEqual(state.player.pos, NewCoord(0, 0)) == false);
+	mu_assert(__func__, state.world_tiles[state.player.pos.x][state.player.pos.y].data->type != TileType_SOLID);
+
+	Cleanup_Test_GameStatePlayerAndDungeon(&state);
+	return 0;
+}
+
+int test_created_bsp_floor_contains_all_rooms_specified() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	InitCreate_DungeonFloor(&state, MAX_ROOMS, FloorLayout_BSP, NULL);
+
+	mu_assert(__func__, state.num_rooms_created == MAX_ROOMS);
+	mu_assert(__func__, state.debug_rcs == 0);
+
+	// Every room must lie within the world without overlapping any other room.
+	for (int i = 0; i < state.num_rooms_created; i++) {
+		mu_assert(__func__, Check_OutOfWorldBounds(state.rooms[i].TL_corner) == false);
+		mu_assert(__func__, Check_OutOfWorldBounds(state.rooms[i].BR_corner) == false);
+
+		for (int j = i + 1; j < state.num_rooms_created; j++) {
+			const bool overlaps = state.rooms[i].TL_corner.x <= state.rooms[j].BR_corner.x && state.rooms[j].TL_corner.x <= state.rooms[i].BR_corner.x
+				&& state.rooms[i].TL_corner.y <= state.rooms[j].BR_corner.y && state.rooms[j].TL_corner.y <= state.rooms[i].BR_corner.y;
+			mu_assert(__func__, overlaps == false);
+		}
+	}
+
+	room_t staircase_room = state.rooms[state.num_rooms_created - 1];
+	coord_t staircase_pos = NewCoord((staircase_room.TL_corner.x + staircase_room.TR_corner.x) / 2, (staircase_room.TL_corner.y + staircase_room.BL_corner.y) / 2);
+	mu_assert(__func__, state.world_tiles[staircase_pos.x][staircase_pos.y].data->sprite == SPR_STAIRCASE);
+
+	Cleanup_Test_GameStatePlayerAndDungeon(&state);
+	return 0;
+}
+
+int test_created_dungeon_floors_staircase_reachable() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	const floor_layout_en layouts[] = {FloorLayout_ROOMS, FloorLayout_BSP, FloorLayout_CAVE};
+	for (int i = 0; i < (int)(sizeof(layouts) / sizeof(layouts[0])); i++) {
+		InitCreate_DungeonFloor(&state, 10, layouts[i], NULL);
+
+		mu_assert(__func__, state.world_tiles[state.staircase_pos.x][state.staircase_pos.y].data->sprite == SPR_STAIRCASE);
+		mu_assert(__func__, state.connectivity.staircase_distance > 0);
+		mu_assert(__func__, state.connectivity.reachable_area > state.connectivity.staircase_distance);
+
+		Cleanup_DungeonFloor(&state);
+	}
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_validate_floor_connectivity_correct_values() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	const int world_area = Get_WorldScreenWidth() * Get_WorldScreenHeight();
+
+	// Wall off the staircase in an otherwise open world.
+	state.player.pos = NewCoord(5, 5);
+	state.staircase_pos = NewCoord(20, 20);
+	Update_WorldTile(&state, state.staircase_pos, GetTileData(TileSlug_STAIRCASE));
+	for (int x = 19; x <= 21; x++) {
+		for (int y = 19; y <= 21; y++) {
+			if (x != 20 || y != 20) {
+				Update_WorldTile(&state, NewCoord(x, y), GetTileData(TileSlug_WALL));
+			}
+		}
+	}
+
+	floor_connectivity_t connectivity = Validate_FloorConnectivity(&state);
+	mu_assert(__func__, connectivity.staircase_distance == -1);
+	mu_assert(__func__, connectivity.reachable_area == world_area - 9);
+
+	// Open the wall above the staircase.
+	Update_WorldTile(&state, NewCoord(20, 19), GetTileData(TileSlug_GROUND));
+
+	connectivity = Validate_FloorConnectivity(&state);
+	mu_assert(__func__, connectivity.staircase_distance == (20 - 5) + (20 - 5));
+	mu_assert(__func__, connectivity.reachable_area == world_area - 7);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_seeded_dungeon_floors_are_identical() {
+	game_state_t state_a = Setup_Test_GameStateAndPlayer();
+	game_state_t state_b = Setup_Test_GameStateAndPlayer();
+
+	Seed_GameState(&state_a, 1234);
+	Seed_GameState(&state_b, 1234);
+	InitCreate_DungeonFloor(&state_a, MAX_ROOMS, FloorLayout_ROOMS, NULL);
+	InitCreate_DungeonFloor(&state_b, MAX_ROOMS, FloorLayout_ROOMS, NULL);
+
+	mu_assert(__func__, state_a.num_rooms_created == state_b.num_rooms_created);
+	mu_assert(__func__, state_a.debug_rcs == state_b.debug_rcs);
+	mu_assert(__func__, CoordsEqual(state_a.player.pos, state_b.player.pos));
+	for (int x = 0; x < Get_WorldScreenWidth(); x++) {
+		for (int y = 0; y < Get_WorldScreenHeight(); y++) {
+			mu_assert(__func__, state_a.world_tiles[x][y].data == state_b.world_tiles[x][y].data);
+		}
+	}
+
+	Cleanup_Test_GameStatePlayerAndDungeon(&state_b);
+	Cleanup_Test_GameStatePlayerAndDungeon(&state_a);
+	return 0;
+}
+
+int test_bitgrid_automaton_correct_values() {
+	bitgrid_t grid;
+	bitgrid_t scratch;
+	Init_BitGrid(&grid, 130, 3);
+	Init_BitGrid(&scratch, 130, 3);
+
+	// A lone wall in open space dies out, a wall pair straddling a word boundary survives, and corners (which border outside cells) fill in.
+	Set_BitGridCell(&grid, 100, 1, true);
+	for (int y = 0; y < 3; y++) {
+		Set_BitGridCell(&grid, 63, y, true);
+		Set_BitGridCell(&grid, 64, y, true);
+	}
+	Step_BitGridAutomaton(&grid, &scratch, 5, 4);
+
+	mu_assert(__func__, Get_BitGridCell(&grid, 100, 1) == false);
+	mu_assert(__func__, Get_BitGridCell(&grid, 63, 1) == true);
+	mu_assert(__func__, Get_BitGridCell(&grid, 64, 1) == true);
+	mu_assert(__func__, Get_BitGridCell(&grid, 62, 1) == false);
+	mu_assert(__func__, Get_BitGridCell(&grid, 65, 1) == false);
+	mu_assert(__func__, Get_BitGridCell(&grid, 0, 0) == true);
+	mu_assert(__func__, Get_BitGridCell(&grid, 129, 2) == true);
+	mu_assert(__func__, Get_BitGridCell(&grid, 130, 1) == false);
+
+	Cleanup_BitGrid(&scratch);
+	Cleanup_BitGrid(&grid);
+	return 0;
+}
+
+int test_open_map_file_correct_extents() {
+	const char *filename = "test_map_file.txt";
+	FILE *fp = fopen(filename, "w");
+	mu_assert(__func__, fp != NULL);
+	fputs("ab\r\nabcd\n\nxyz", fp);
+	fclose(fp);
+
+	// Windows line endings are trimmed, empty lines are kept and a final line without a newline still counts.
+	map_file_t map;
+	mu_assert(__func__, Open_MapFileData(&map, filename) == true);
+	Find_MapFileLines(&map);
+	mu_assert(__func__, map.num_lines == 4);
+	mu_assert(__func__, map.longest_line == 4);
+	mu_assert(__func__, map.lines[0].length == 2 && strncmp(map.lines[0].chars, "ab", 2) == 0);
+	mu_assert(__func__, map.lines[1].length == 4 && strncmp(map.lines[1].chars, "abcd", 4) == 0);
+	mu_assert(__func__, map.lines[2].length == 0);
+	mu_assert(__func__, map.lines[3].length == 3 && strncmp(map.lines[3].chars, "xyz", 3) == 0);
+	Close_MapFile(&map);
+	remove(filename);
+
+	mu_assert(__func__, Open_MapFileData(&map, "this_map_does_not_exist.txt") == false);
+	mu_assert(__func__, map.num_lines == 0);
+	return 0;
+}
+
+int test_created_floor_from_template_correct_positions() {
+	const char *filename = "test_floor_from_template.txt";
+	FILE *fp = fopen(filename, "w");
+	mu_assert(__func__, fp != NULL);
+	fputs("#######\n#@ Zf^#\n#######\n", fp);
+	fclose(fp);
+
+	map_template_t map_template;
+	mu_assert(__func__, Init_MapTemplate(&map_template, filename) == true);
+	remove(filename);
+	mu_assert(__func__, map_template.width == 7 && map_template.height == 3);
+	mu_assert(__func__, map_template.num_enemy_spawns == 1);
+
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	// Stamping the same template twice creates the same floor, with fresh enemies each time.
+	for (int i = 0; i < 2; i++) {
+		InitCreate_DungeonFloor(&state, MIN_ROOMS, FloorLayout_ROOMS, &map_template);
+
+		// The 7x3 map is centered in the world.
+		const coord_t anchor = NewCoord((Get_WorldScreenWidth() / 2) - 3, (Get_WorldScreenHeight() / 2) - 1);
+		mu_assert(__func__, CoordsEqual(state.player.pos, NewCoord(anchor.x + 1, anchor.y + 1)));
+		mu_assert(__func__, CoordsEqual(state.staircase_pos, NewCoord(anchor.x + 5, anchor.y + 1)));
+		mu_assert(__func__, state.world_tiles[anchor.x + 6][anchor.y + 2].data->type == TileType_SOLID);
+		mu_assert(__func__, state.world_tiles[anchor.x + 4][anchor.y + 1].item_occupier == GetItem(ItmSlug_SMALLFOOD));
+		mu_assert(__func__, state.world_tiles[anchor.x + 3][anchor.y + 1].enemy_occupier == 0);
+		mu_assert(__func__, state.enemy_pool.num_slots == 1);
+		mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, 0)->pos, NewCoord(anchor.x + 3, anchor.y + 1)));
+		mu_assert(__func__, state.connectivity.staircase_distance == 4);
+
+		Cleanup_DungeonFloor(&state);
+	}
+
+	Cleanup_GameState(&state);
+	Cleanup_MapTemplate(&map_template);
+
+	mu_assert(__func__, Init_MapTemplate(&map_template, "this_map_does_not_exist.txt") == false);
+	return 0;
+}
+
+int test_compiled_map_template_matches_source() {
+	const char *source_filename = "test_compiled_map.txt";
+	const char *compiled_filename = "test_compiled_map.map";
+	FILE *fp = fopen(source_filename, "w");
+	mu_assert(__func__, fp != NULL);
+	fputs(";;;;;;;\n#@ Zf^#\n#  G\n", fp);
+	fclose(fp);
+
+	map_template_t source;
+	map_template_t compiled;
+	mu_assert(__func__, Init_MapTemplate(&source, source_filename) == true);
+	mu_assert(__func__, Save_MapTemplate(&source, compiled_filename) == true);
+	mu_assert(__func__, Init_MapTemplate(&compiled, compiled_filename) == true);
+
+	mu_assert(__func__, compiled.width == source.width && compiled.height == source.height);
+	mu_assert(__func__, CoordsEqual(compiled.anchor, source.anchor));
+	mu_assert(__func__, CoordsEqual(compiled.player_spawn, source.player_spawn));
+	mu_assert(__func__, CoordsEqual(compiled.staircase_pos, source.staircase_pos));
+	mu_assert(__func__, compiled.num_enemy_spawns == 1 && compiled.enemy_spawns[0].data == source.enemy_spawns[0].data);
+	mu_assert(__func__, CoordsEqual(compiled.enemy_spawns[0].pos, source.enemy_spawns[0].pos));
+	for (int i = 0; i < source.width * source.height; i++) {
+		mu_assert(__func__, compiled.tiles[i].data == source.tiles[i].data);
+		mu_assert(__func__, compiled.tiles[i].item_occupier == source.tiles[i].item_occupier);
+	}
+	Cleanup_MapTemplate(&compiled);
+
+	// A truncated compiled map is rejected rather than partially loaded.
+	truncate(compiled_filename, 20);
+	mu_assert(__func__, Init_MapTemplate(&compiled, compiled_filename) == false);
+
+	Cleanup_MapTemplate(&source);
+	remove(source_filename);
+	remove(compiled_filename);
+	return 0;
+}
+
+int test_prefab_library_stamped_into_floors() {
+	const char *directory = "test_prefabs";
+	const char *valid_filename = "test_prefabs/a_room.txt";
+	const char *invalid_filename = "test_prefabs/b_even.txt";
+	const char *ignored_filename = "test_prefabs/c_notes.md";
+	mkdir(directory, 0755);
+
+	FILE *fp = fopen(valid_filename, "w");
+	mu_assert(__func__, fp != NULL);
+	fputs("###?###\n#1    #\n#     #\n?     #\n#     #\n#     #\n###?###\n", fp);
+	fclose(fp);
+	fp = fopen(invalid_filename, "w");
+	mu_assert(__func__, fp != NULL);
+	fputs("##?#\n#  #\n#  #\n####\n", fp);
+	fclose(fp);
+	fp = fopen(ignored_filename, "w");
+	mu_assert(__func__, fp != NULL);
+	fputs("###?###\n", fp);
+	fclose(fp);
+
+	// Only the valid txt prefab is loaded, indexed by its radius and doors (up, down and left).
+	prefab_library_t library;
+	mu_assert(__func__, Init_PrefabLibrary(&library, directory) == true);
+	mu_assert(__func__, library.num_prefabs == 1);
+	mu_assert(__func__, library.prefabs[0].radius == 3);
+	mu_assert(__func__, library.prefabs[0].door_mask == ((1u << Dir_UP) | (1u << Dir_DOWN) | (1u << Dir_LEFT)));
+	mu_assert(__func__, Count_Prefabs(&library, 3, 1u << Dir_LEFT) == 1);
+	mu_assert(__func__, Count_Prefabs(&library, 3, 1u << Dir_RIGHT) == 0);
+	mu_assert(__func__, Count_Prefabs(&library, 2, 0) == 0);
+	mu_assert(__func__, Get_Prefab(&library, 3, 1u << Dir_UP, 0) == &library.prefabs[0]);
+
+	// The prefab's merchant only exists on floors where the generators stamped the prefab.
+	bool prefab_stamped[2] = {false, false};
+	const floor_layout_en layouts[2] = {FloorLayout_ROOMS, FloorLayout_BSP};
+	for (int i = 0; i < 2; i++) {
+		for (unsigned int seed = 0; seed < 20 && !prefab_stamped[i]; seed++) {
+			game_state_t state = Setup_Test_GameStateAndPlayer();
+			state.prefab_library = &library;
+			Seed_GameState(&state, seed);
+			InitCreate_DungeonFloor(&state, MAX_ROOMS, layouts[i], NULL);
+
+			// Stamped tiles bring their items into the item spatial hash too.
+			int num_items = 0;
+			for (int x = 0; x < Get_WorldScreenWidth(); x++) {
+				for (int y = 0; y < Get_WorldScreenHeight(); y++) {
+					prefab_stamped[i] |= (state.world_tiles[x][y].data == GetTileData(TileSlug_MERCHANT));
+					num_items += (state.world_tiles[x][y].item_occupier != NULL);
+				}
+			}
+			mu_assert(__func__, state.item_hash.num_listed == num_items);
+			Cleanup_Test_GameStatePlayerAndDungeon(&state);
+		}
+		mu_assert(__func__, prefab_stamped[i]);
+	}
+
+	Cleanup_PrefabLibrary(&library);
+	remove(valid_filename);
+	remove(invalid_filename);
+	remove(ignored_filename);
+	rmdir(directory);
+	return 0;
+}
+
+int test_sprite_decoding_matches_databases() {
+	// Every database entry's sprite decodes back to that entry, so no two entries share a sprite.
+	for (int slug = 0; slug < TileSlug_COUNT; slug++) {
+		const sprite_decoding_t *decoding = GetSpriteDecoding(GetTileData(slug)->sprite);
+		mu_assert(__func__, decoding->tile_slug == (tile_slug_en)slug);
+		mu_assert(__func__, decoding->item_slug == ItmSlug_NONE && !decoding->is_enemy && !decoding->is_player);
+	}
+	for (int slug = ItmSlug_NONE + 1; slug < ItmSlug_COUNT; slug++) {
+		const sprite_decoding_t *decoding = GetSpriteDecoding(GetItem(slug)->sprite);
+		mu_assert(__func__, decoding->item_slug == (item_slug_en)slug);
+		mu_assert(__func__, decoding->tile_slug == TileSlug_GROUND && !decoding->is_enemy && !decoding->is_player);
+	}
+	for (int slug = 0; slug < EnmySlug_COUNT; slug++) {
+		const sprite_decoding_t *decoding = GetSpriteDecoding(GetEnemyData(slug)->sprite);
+		mu_assert(__func__, decoding->is_enemy && decoding->enemy_slug == (enemy_slug_en)slug);
+		mu_assert(__func__, decoding->tile_slug == TileSlug_GROUND && decoding->item_slug == ItmSlug_NONE && !decoding->is_player);
+	}
+
+	mu_assert(__func__, GetSpriteDecoding(SPR_PLAYER)->is_player);
+	mu_assert(__func__, GetSpriteDecoding(_UNITY_VOID_SPRITE)->tile_slug == TileSlug_VOID);
+	mu_assert(__func__, GetSpriteDecoding('\t')->tile_slug == TileSlug_GROUND);
+	mu_assert(__func__, GetSpriteDecoding((char)0xFF)->tile_slug == TileSlug_GROUND);
+	return 0;
+}
+
+int test_enemy_pool_reuses_slots_and_resets() {
+	const int num_enemies = 200;
+	arena_t arena;
+	Init_Arena(&arena, Get_EnemyPoolSize(num_enemies + 1, num_enemies, 2));
+
+	enemy_pool_t pool;
+	Init_EnemyPool(&pool, &arena, num_enemies + 1, num_enemies, 2);
+	mu_assert(__func__, arena.used == Get_EnemyPoolSize(num_enemies + 1, num_enemies, 2));
+
+	for (int i = 0; i < num_enemies; i++) {
+		mu_assert(__func__, AddTo_EnemyPool(&pool, Create_Enemy(GetEnemyData(EnmySlug_ZOMBIE), NewCoord(i, 0))) == i);
+	}
+	for (int i = 0; i < num_enemies; i++) {
+		mu_assert(__func__, Get_PoolEnemy(&pool, i)->pos.x == i);
+	}
+
+	// Removed slots are reused, most recently removed first, before any new slot.
+	RemoveFrom_EnemyPool(&pool, 5);
+	RemoveFrom_EnemyPool(&pool, 9);
+	mu_assert(__func__, Get_PoolEnemy(&pool, 5)->is_alive == false);
+	mu_assert(__func__, pool.num_active == num_enemies - 2);
+	mu_assert(__func__, AddTo_EnemyPool(&pool, Create_Enemy(GetEnemyData(EnmySlug_WEREWOLF), NewCoord(0, 1))) == 9);
+	mu_assert(__func__, AddTo_EnemyPool(&pool, Create_Enemy(GetEnemyData(EnmySlug_WEREWOLF), NewCoord(0, 1))) == 5);
+	mu_assert(__func__, AddTo_EnemyPool(&pool, Create_Enemy(GetEnemyData(EnmySlug_WEREWOLF), NewCoord(0, 1))) == num_enemies);
+	mu_assert(__func__, Get_PoolEnemy(&pool, 5)->data == GetEnemyData(EnmySlug_WEREWOLF));
+
+	// A reset empties the pool in one step.
+	Reset_EnemyPool(&pool);
+	mu_assert(__func__, pool.num_slots == 0 && pool.num_free_slots == 0);
+	mu_assert(__func__, AddTo_EnemyPool(&pool, Create_Enemy(GetEnemyData(EnmySlug_ZOMBIE), NewCoord(0, 0))) == 0);
+
+	Cleanup_Arena(&arena);
+	return 0;
+}
+
+int test_floor_arena_reset_between_floors() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	const unsigned char *arena_memory = state.floor_arena.memory;
+	const size_t empty_floor_size = state.floor_arena.used;
+
+	// Every floor's allocations come from the same arena, and are released at once by the floor's cleanup.
+	const floor_layout_en layouts[3] = {FloorLayout_ROOMS, FloorLayout_BSP, FloorLayout_CAVE};
+	for (int i = 0; i < 3; i++) {
+		InitCreate_DungeonFloor(&state, MAX_ROOMS, layouts[i], NULL);
+		mu_assert(__func__, (const unsigned char *)state.rooms >= arena_memory && (const unsigned char *)state.rooms < arena_memory + state.floor_arena.capacity);
+		mu_assert(__func__, state.floor_arena.used > empty_floor_size);
+		mu_assert(__func__, state.floor_arena.high_water >= state.floor_arena.used);
+
+		Cleanup_DungeonFloor(&state);
+		mu_assert(__func__, state.floor_arena.used == empty_floor_size);
+		mu_assert(__func__, state.floor_arena.high_water == empty_floor_size);
+		mu_assert(__func__, state.floor_arena.memory == arena_memory);
+	}
+
+	// Cave generation's grids were the largest floor allocations, and stayed within the arena.
+	mu_assert(__func__, state.floor_arena.peak > empty_floor_size + Get_BitGridSize(Get_WorldScreenWidth(), Get_WorldScreenHeight()) * 3);
+	mu_assert(__func__, state.floor_arena.peak <= state.floor_arena.capacity);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_killed_enemies_removed_and_slots_reused() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	const int zombie = Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(1, 1));
+	const int werewolf = Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(2, 1));
+	Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(3, 1));
+	Get_PoolEnemy(&state.enemy_pool, werewolf)->loot = GetItem(ItmSlug_BIGFOOD);
+
+	// A killed enemy leaves the active set and its tile immediately, dropping its loot.
+	Kill_Enemy(&state, werewolf);
+	mu_assert(__func__, state.enemy_pool.num_active == 2);
+	mu_assert(__func__, WorldTile_Enemy_IsEqualTo(&state, NewCoord(2, 1), ENEMY_NONE));
+	mu_assert(__func__, WorldTile_Item_IsEqualTo(&state, NewCoord(2, 1), GetItem(ItmSlug_BIGFOOD)));
+	for (int i = 0; i < state.enemy_pool.num_active; i++) {
+		mu_assert(__func__, state.enemy_pool.active_slots[i] != werewolf);
+	}
+
+	// The next spawn reuses the dead enemy's slot.
+	mu_assert(__func__, Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(4, 1)) == werewolf);
+	mu_assert(__func__, state.enemy_pool.num_active == 3 && state.enemy_pool.num_slots == 3);
+
+	// Enemies killed in combat are removed the same way, when the player bumps into them.
+	state.player.pos = NewCoord(1, 2);
+	Get_PoolEnemy(&state.enemy_pool, zombie)->curr_health = 1;
+	state.debug_injected_inputs[0] = KEY_UP;
+	Process(&state);
+	mu_assert(__func__, state.enemy_pool.num_active == 2);
+	mu_assert(__func__, WorldTile_Enemy_IsEqualTo(&state, NewCoord(1, 1), ENEMY_NONE));
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_enemies_follow_flow_field_to_player() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// A ground corridor along row 1 from (1, 1) to (8, 1), with a wall at (5, 1) cutting off its right end.
+	for (int x = 1; x <= 8; x++) {
+		Update_WorldTile(&state, NewCoord(x, 1), GetTileData(TileSlug_GROUND));
+	}
+	Update_WorldTile(&state, NewCoord(5, 1), GetTileData(TileSlug_WALL));
+	state.player.pos = NewCoord(1, 1);
+
+	const int near = Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(2, 1));
+	const int chaser = Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(4, 1));
+	const int blocked = Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(7, 1));
+
+	Update_ActiveRegion(&state);
+	Update_FlowField(&state);
+	mu_assert(__func__, state.flow_field[(1 * world_screen_h) + 1] == 0);
+	mu_assert(__func__, state.flow_field[(4 * world_screen_h) + 1] == 3);
+	mu_assert(__func__, state.flow_field[(5 * world_screen_h) + 1] == FLOW_FIELD_UNREACHED);
+	mu_assert(__func__, state.flow_field[(7 * world_screen_h) + 1] == FLOW_FIELD_UNREACHED);
+	mu_assert(__func__, state.flow_field[(1 * world_screen_h) + 2] == FLOW_FIELD_UNREACHED);		// Void isn't walkable.
+
+	// Enemies step downhill, but never onto another enemy, and unreachable enemies stay put.
+	Update_EnemyTurns(&state);
+	mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, near)->pos, NewCoord(2, 1)));
+	mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, chaser)->pos, NewCoord(3, 1)));
+	mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, blocked)->pos, NewCoord(7, 1)));
+	mu_assert(__func__, WorldTile_Enemy_IsEqualTo(&state, NewCoord(4, 1), ENEMY_NONE));
+	mu_assert(__func__, WorldTile_Enemy_IsEqualTo(&state, NewCoord(3, 1), chaser));
+
+	Update_FlowField(&state);
+	Update_EnemyTurns(&state);
+	mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, chaser)->pos, NewCoord(3, 1)));
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_active_region_wakes_only_nearby_enemies() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	const int wake_radius = Get_EnemyWakeRadius(&state.player);
+	const int far_x = (wake_radius + ENEMY_CELL_SIZE) * 2;
+
+	state.player.pos = NewCoord(0, 0);
+	const int near = Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(1, 1));
+	const int far = Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(far_x, 0));
+	const int doomed = Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(far_x, 1));
+	mu_assert(__func__, state.enemy_pool.num_awake == 0);
+
+	// Only the enemy within the wake radius wakes.
+	Update_ActiveRegion(&state);
+	mu_assert(__func__, state.enemy_pool.num_awake == 1 && state.enemy_pool.awake_slots[0] == near);
+
+	// Sleeping enemies can still be killed, leaving their cell.
+	Kill_Enemy(&state, doomed);
+	mu_assert(__func__, state.enemy_pool.num_active == 2 && state.enemy_pool.num_awake == 1);
+
+	// Walking over wakes the far enemy, and the near enemy falls asleep once it is more than a cell beyond the radius.
+	state.player.pos = NewCoord(far_x - 1, 0);
+	Update_ActiveRegion(&state);
+	mu_assert(__func__, state.enemy_pool.num_awake == 1 && state.enemy_pool.awake_slots[0] == far);
+	mu_assert(__func__, state.enemy_pool.awake_positions[near] == ENEMY_ASLEEP);
+
+	// Back again, the near enemy wakes from its cell and the removed enemy never reappears.
+	state.player.pos = NewCoord(0, 0);
+	Update_ActiveRegion(&state);
+	mu_assert(__func__, state.enemy_pool.num_awake == 1 && state.enemy_pool.awake_slots[0] == near);
+	Update_ActiveRegion(&state);
+	mu_assert(__func__, state.enemy_pool.num_awake == 1);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_scheduler_pops_due_actors_in_time_order() {
+	const int num_actors = 3000;
+	const int speeds[4] = {50, 80, 100, 125};
+	arena_t arena;
+	Init_Arena(&arena, Get_SchedulerSize(num_actors));
+
+	scheduler_t scheduler;
+	Init_Scheduler(&scheduler, &arena, num_actors);
+	for (int i = 0; i < num_actors; i++) {
+		Schedule_Actor(&scheduler, i, 0);
+	}
+
+	// Run 20 turns, rescheduling every actor by its own speed, like 'Update_EnemyTurns'.
+	int actions[3000] = {0};
+	long long last_time = 0;
+	int last_actor = -1;
+	for (int turn = 0; turn < 20; turn++) {
+		const long long turn_end = (turn + 1) * Get_ActionDelay(PLAYER_SPEED);
+		long long time;
+		int actor;
+		while ((actor = Pop_DueActor(&scheduler, turn_end, &time)) != SCHEDULER_NONE) {
+			mu_assert(__func__, time < turn_end);
+			mu_assert(__func__, time > last_time || (time == last_time && actor > last_actor));
+			last_time = time;
+			last_actor = actor;
+			actions[actor]++;
+			Schedule_Actor(&scheduler, actor, time + Get_ActionDelay(speeds[actor % 4]));
+		}
+	}
+
+	// Over 2000 time units every actor acted once per delay it fits, however many actors share the queue.
+	for (int i = 0; i < num_actors; i++) {
+		const long long delay = Get_ActionDelay(speeds[i % 4]);
+		mu_assert(__func__, actions[i] == (int)(((20 * Get_ActionDelay(PLAYER_SPEED)) + delay - 1) / delay));
+	}
+
+	// Unscheduled actors are never popped.
+	Unschedule_Actor(&scheduler, 7);
+	mu_assert(__func__, !Check_ActorScheduled(&scheduler, 7) && Check_ActorScheduled(&scheduler, 8));
+	mu_assert(__func__, scheduler.heap_size == num_actors - 1);
+	Reset_Scheduler(&scheduler);
+	mu_assert(__func__, !Check_ActorScheduled(&scheduler, 8));
+	long long time;
+	mu_assert(__func__, Pop_DueActor(&scheduler, 1000000, &time) == SCHEDULER_NONE);
+
+	Cleanup_Arena(&arena);
+	return 0;
+}
+
+int test_enemies_attack_only_with_their_own_actions() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	state.player.pos = NewCoord(5, 5);
+	state.player.stats.curr_health = 100;
+
+	// A ground corridor along row 5, with a zombie next to the player, a zombie a step away from being next to it, and one diagonal on the void (out of reach).
+	for (int x = 1; x <= 9; x++) {
+		Update_WorldTile(&state, NewCoord(x, 5), GetTileData(TileSlug_GROUND));
+	}
+	const int adjacent = Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(4, 5));
+	const int approaching = Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(7, 5));
+	Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(6, 6));
+
+	// Zombies are slower than the player, acting at turn 0, 1.25, 2.5 and 3.75, so nobody hits the player on turn 4. The approaching zombie's first action
+	// only brings it next to the player.
+	mu_assert(__func__, GetEnemyData(EnmySlug_ZOMBIE)->speed == 80 && state.player.stats.speed == PLAYER_SPEED);
+	const int expected_health[5] = {99, 97, 95, 93, 93};
+	for (int turn = 0; turn < 5; turn++) {
+		Update_ActiveRegion(&state);
+		Update_FlowField(&state);
+		Update_EnemyTurns(&state);
+		mu_assert(__func__, state.player.stats.curr_health == expected_health[turn]);
+		if (turn == 0) {
+			mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, approaching)->pos, NewCoord(6, 5)));
+		}
+	}
+
+	// Attacking doesn't move the enemy, and the enemy isn't hit back.
+	mu_assert(__func__, CoordsEqual(Get_PoolEnemy(&state.enemy_pool, adjacent)->pos, NewCoord(4, 5)));
+	mu_assert(__func__, Get_PoolEnemy(&state.enemy_pool, adjacent)->curr_health == GetEnemyData(EnmySlug_ZOMBIE)->max_health);
+	mu_assert(__func__, Get_GameLogEventStats(&state.game_log, LogEvent_ENEMY_DMG_PLR).count == 7);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_enemy_turns_identical_across_planner_threads() {
+	const int num_turns = 25;
+	unsigned long long serial_hashes[25];
+	unsigned long long single_hashes[25];
+	unsigned long long parallel_hashes[25];
+
+	// Planning on the calling thread, on a pool of 1 thread and on a pool of 4 threads must reach exactly the same states.
+	Run_Test_CrowdedEnemyTurns(NULL, serial_hashes, num_turns);
+
+	thread_pool_t single_planner;
+	Init_ThreadPool(&single_planner, 1);
+	Run_Test_CrowdedEnemyTurns(&single_planner, single_hashes, num_turns);
+	Cleanup_ThreadPool(&single_planner);
+
+	thread_pool_t parallel_planners;
+	Init_ThreadPool(&parallel_planners, 4);
+	Run_Test_CrowdedEnemyTurns(&parallel_planners, parallel_hashes, num_turns);
+	Cleanup_ThreadPool(&parallel_planners);
+
+	for (int turn = 0; turn < num_turns; turn++) {
+		mu_assert(__func__, serial_hashes[turn] == single_hashes[turn]);
+		mu_assert(__func__, serial_hashes[turn] == parallel_hashes[turn]);
+	}
+
+	// The enemies did move, so the hashes compared more than a still floor.
+	mu_assert(__func__, serial_hashes[0] != serial_hashes[1] && serial_hashes[1] != serial_hashes[num_turns - 1]);
+	return 0;
+}
+
+int test_spatial_hash_queries_match_world() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// Scatter enemies and items, then move and kill some, all through the occupier setters.
+	unsigned int layout_seed = 99;
+	for (int i = 0; i < 300; i++) {
+		const coord_t pos = NewCoord(rand_r(&layout_seed) % world_screen_w, rand_r(&layout_seed) % world_screen_h);
+		if (i % 3 == 0) {
+			Update_WorldTileItemOccupier(&state, pos, GetItem(ItmSlug_SMALLFOOD));
+		} else if (state.world_tiles[pos.x][pos.y].enemy_occupier == ENEMY_NONE) {
+			Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), pos);
+		}
+	}
+	for (int i = 0; i < state.enemy_pool.num_active; i += 4) {
+		Kill_Enemy(&state, state.enemy_pool.active_slots[i]);
+	}
+	for (int i = 0; i < state.enemy_pool.num_active; i += 3) {
+		const int enemy_index = state.enemy_pool.active_slots[i];
+		enemy_t *enemy = Get_PoolEnemy(&state.enemy_pool, enemy_index);
+		const coord_t pos = NewCoord((enemy->pos.x + 1) % world_screen_w, enemy->pos.y);
+		if (state.world_tiles[pos.x][pos.y].enemy_occupier == ENEMY_NONE) {
+			Update_WorldTileEnemyOccupier(&state, enemy->pos, ENEMY_NONE);
+			Update_WorldTileEnemyOccupier(&state, pos, enemy_index);
+			enemy->pos = pos;
+		}
+	}
+	mu_assert(__func__, state.enemy_hash.num_listed == state.enemy_pool.num_active);
+
+	// Radius and rectangle queries find exactly the enemies a scan of the world finds.
+	int found[3000];
+	const coord_t centers[3] = {NewCoord(0, 0), NewCoord(world_screen_w / 2, world_screen_h / 2), NewCoord(world_screen_w - 1, 3)};
+	for (int c = 0; c < 3; c++) {
+		const int radius = 5 + (c * 6);
+		const int num_found = Find_EnemiesInRadius(&state, centers[c], radius, found, 3000);
+		int num_expected = 0;
+		for (int x = 0; x < world_screen_w; x++) {
+			for (int y = 0; y < world_screen_h; y++) {
+				const int dx = x - centers[c].x;
+				const int dy = y - centers[c].y;
+				if (state.world_tiles[x][y].enemy_occupier != ENEMY_NONE && (dx * dx) + (dy * dy) <= radius * radius) {
+					num_expected++;
+				}
+			}
+		}
+		mu_assert(__func__, num_found == num_expected);
+		for (int i = 0; i < num_found; i++) {
+			const coord_t pos = Get_PoolEnemy(&state.enemy_pool, found[i])->pos;
+			mu_assert(__func__, ((pos.x - centers[c].x) * (pos.x - centers[c].x)) + ((pos.y - centers[c].y) * (pos.y - centers[c].y)) <= radius * radius);
+		}
+	}
+	mu_assert(__func__, Find_EnemiesInRect(&state, NewCoord(0, 0), NewCoord(world_screen_w - 1, world_screen_h - 1), found, 3000) == state.enemy_pool.num_active);
+	mu_assert(__func__, Find_EnemiesInRect(&state, NewCoord(0, 0), NewCoord(world_screen_w - 1, world_screen_h - 1), found, 4) == 4);
+
+	// The nearest item matches a scan of the world (fewest steps, then lowest tile index).
+	for (int c = 0; c < 3; c++) {
+		int best_distance = -1;
+		coord_t best = NewCoord(-1, -1);
+		for (int x = 0; x < world_screen_w; x++) {
+			for (int y = 0; y < world_screen_h; y++) {
+				const int distance = abs(x - centers[c].x) + abs(y - centers[c].y);
+				if (state.world_tiles[x][y].item_occupier != NULL && (best_distance == -1 || distance < best_distance)) {
+					best_distance = distance;
+					best = NewCoord(x, y);
+				}
+			}
+		}
+
+		coord_t nearest;
+		mu_assert(__func__, Find_NearestItem(&state, centers[c], world_screen_w + world_screen_h, &nearest));
+		mu_assert(__func__, CoordsEqual(nearest, best));
+		mu_assert(__func__, !Find_NearestItem(&state, centers[c], best_distance - 1, &nearest) || best_distance == 0);
+	}
+
+	// Floors stamped from templates and prefabs keep the hashes in step with the world as well.
+	Cleanup_Test_GameStateAndPlayer(&state);
+	state = Setup_Test_GameStatePlayerAndDungeon();
+	int num_items = 0;
+	int num_enemies = 0;
+	for (int x = 0; x < world_screen_w; x++) {
+		for (int y = 0; y < world_screen_h; y++) {
+			num_items += (state.world_tiles[x][y].item_occupier != NULL);
+			num_enemies += (state.world_tiles[x][y].enemy_occupier != ENEMY_NONE);
+		}
+	}
+	mu_assert(__func__, state.item_hash.num_listed == num_items && state.enemy_hash.num_listed == num_enemies);
+
+	Cleanup_Test_GameStatePlayerAndDungeon(&state);
+	return 0;
+}
+
+int test_find_path_shortest_around_walls() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	// A 7x5 ground area from (1, 1) to (7, 5), split by a wall along column 4 except for a gap at (4, 5).
+	for (int x = 1; x <= 7; x++) {
+		for (int y = 1; y <= 5; y++) {
+			Update_WorldTile(&state, NewCoord(x, y), GetTileData((x == 4 && y != 5) ? TileSlug_WALL : TileSlug_GROUND));
+		}
+	}
+
+	// The path has to detour through the gap: 4 steps down, 6 right and 4 up.
+	mu_assert(__func__, Find_Path(&state, NewCoord(1, 1), NewCoord(7, 1)) == 14);
+	mu_assert(__func__, state.pathfinder.path_length == 14);
+	mu_assert(__func__, CoordsEqual(state.pathfinder.path[13], NewCoord(7, 1)));
+	for (int i = 0; i < state.pathfinder.path_length; i++) {
+		const coord_t previous = (i == 0) ? NewCoord(1, 1) : state.pathfinder.path[i - 1];
+		const coord_t step = state.pathfinder.path[i];
+		mu_assert(__func__, abs(step.x - previous.x) + abs(step.y - previous.y) == 1);
+		mu_assert(__func__, Check_EnemyWalkable(&state.world_tiles[step.x][step.y]));
+	}
+	mu_assert(__func__, state.pathfinder.nodes_expanded > 0 && state.pathfinder.nodes_expanded <= 7 * 5);
+
+	// Later queries reuse the same nodes without clearing them.
+	mu_assert(__func__, Find_Path(&state, NewCoord(2, 3), NewCoord(2, 3)) == 0);
+	mu_assert(__func__, Find_Path(&state, NewCoord(1, 1), NewCoord(3, 1)) == 2);
+	mu_assert(__func__, state.pathfinder.nodes_expanded == 3);
+
+	// Sealing the gap leaves no path, and void is never walked on.
+	Update_WorldTile(&state, NewCoord(4, 5), GetTileData(TileSlug_WALL));
+	mu_assert(__func__, Find_Path(&state, NewCoord(1, 1), NewCoord(7, 1)) == PATH_NOT_FOUND);
+	mu_assert(__func__, Find_Path(&state, NewCoord(1, 1), NewCoord(1, 7)) == PATH_NOT_FOUND);
+	mu_assert(__func__, state.pathfinder.num_queries == 5);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_field_of_view_blocked_by_walls_and_symmetric() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	// A ground area from (1, 1) to (25, 20), split by a wall along column 13.
+	for (int x = 1; x <= 25; x++) {
+		for (int y = 1; y <= 20; y++) {
+			Update_WorldTile(&state, NewCoord(x, y), GetTileData((x == 13) ? TileSlug_WALL : TileSlug_GROUND));
+		}
+	}
+	state.player.pos = NewCoord(6, 10);
+	Update_FieldOfView(&state);
+
+	// The wall is seen, but nothing behind it, and nothing as far as 'max_vision'.
+	mu_assert(__func__, Get_BitGridCell(&state.visible_mask, 6, 10));
+	mu_assert(__func__, Get_BitGridCell(&state.visible_mask, 12, 10));
+	mu_assert(__func__, Get_BitGridCell(&state.visible_mask, 13, 10));
+	mu_assert(__func__, !Get_BitGridCell(&state.visible_mask, 14, 10));
+	mu_assert(__func__, Get_BitGridCell(&state.visible_mask, 6, 19));
+	mu_assert(__func__, !Get_BitGridCell(&state.visible_mask, 6, 20));
+	mu_assert(__func__, !state.fov_dirty);
+
+	// Hidden tiles changing leave the visible tiles as they are, but opening the wall shows what is behind it.
+	Update_WorldTile(&state, NewCoord(20, 3), GetTileData(TileSlug_WALL));
+	mu_assert(__func__, !state.fov_dirty);
+	Update_WorldTile(&state, NewCoord(13, 10), GetTileData(TileSlug_GROUND));
+	mu_assert(__func__, state.fov_dirty);
+	Update_FieldOfView(&state);
+	mu_assert(__func__, Get_BitGridCell(&state.visible_mask, 14, 10));
+	mu_assert(__func__, Get_BitGridCell(&state.visible_mask, 15, 10));
+
+	// Over scattered walls, every open tile sees each open tile that sees it.
+	unsigned int layout_seed = 1234;
+	for (int x = 1; x <= 25; x++) {
+		for (int y = 1; y <= 20; y++) {
+			Update_WorldTile(&state, NewCoord(x, y), GetTileData((rand_r(&layout_seed) % 4 == 0) ? TileSlug_WALL : TileSlug_GROUND));
+		}
+	}
+	bitgrid_t views[10][10];
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 10; j++) {
+			Init_BitGrid(&views[i][j], state.solid_mask.width, state.solid_mask.height);
+			Compute_FieldOfView(&state.solid_mask, &views[i][j], NewCoord(3 + (i * 2), 1 + (j * 2)), PLAYER_MAX_VISION);
+		}
+	}
+	for (int a = 0; a < 100; a++) {
+		for (int b = 0; b < 100; b++) {
+			const coord_t pos_a = NewCoord(3 + ((a / 10) * 2), 1 + ((a % 10) * 2));
+			const coord_t pos_b = NewCoord(3 + ((b / 10) * 2), 1 + ((b % 10) * 2));
+			if (!Get_BitGridCell(&state.solid_mask, pos_a.x, pos_a.y) && !Get_BitGridCell(&state.solid_mask, pos_b.x, pos_b.y)) {
+				mu_assert(__func__, Get_BitGridCell(&views[a / 10][a % 10], pos_b.x, pos_b.y) == Get_BitGridCell(&views[b / 10][b % 10], pos_a.x, pos_a.y));
+			}
+		}
+	}
+	for (int i = 0; i < 10; i++) {
+		for (int j = 0; j < 10; j++) {
+			Cleanup_BitGrid(&views[i][j]);
+		}
+	}
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_explored_tiles_remembered_out_of_view() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	// A ground area from (1, 1) to (40, 20), with an item and an enemy in sight of the player's first position.
+	for (int x = 1; x <= 40; x++) {
+		for (int y = 1; y <= 20; y++) {
+			Update_WorldTile(&state, NewCoord(x, y), GetTileData(TileSlug_GROUND));
+		}
+	}
+	Update_WorldTileItemOccupier(&state, NewCoord(2, 10), GetItem(ItmSlug_SMALLFOOD));
+	Spawn_Enemy(&state, GetEnemyData(EnmySlug_ZOMBIE), NewCoord(3, 10));
+	state.player.pos = NewCoord(5, 10);
+	Update_FieldOfView(&state);
+	mu_assert(__func__, Count_BitGridCells(&state.explored_mask) == Count_BitGridCells(&state.visible_mask));
+
+	// Walking away leaves the first tiles explored but out of view.
+	state.player.pos = NewCoord(30, 10);
+	Update_FieldOfView(&state);
+	mu_assert(__func__, Get_BitGridCell(&state.explored_mask, 2, 10) && !Get_BitGridCell(&state.visible_mask, 2, 10));
+	mu_assert(__func__, Get_BitGridCell(&state.explored_mask, 38, 10) && Get_BitGridCell(&state.visible_mask, 38, 10));
+	mu_assert(__func__, !Get_BitGridCell(&state.explored_mask, 40, 1));
+	mu_assert(__func__, Count_BitGridCells(&state.explored_mask) > Count_BitGridCells(&state.visible_mask));
+
+	// The item is remembered, but the enemy isn't.
+	const int item_glyph = (10 * state.remembered_glyphs.width) + 2;
+	const int enemy_glyph = (10 * state.remembered_glyphs.width) + 3;
+	mu_assert(__func__, state.remembered_glyphs.sprites[item_glyph] == GetItem(ItmSlug_SMALLFOOD)->sprite);
+	mu_assert(__func__, state.remembered_glyphs.colours[item_glyph] == (Get_TileForegroundColour(&state.world_tiles[2][10]) | GEO_DIM));
+	mu_assert(__func__, state.remembered_glyphs.sprites[enemy_glyph] == GetTileData(TileSlug_GROUND)->sprite);
+
+	// A new floor starts unexplored.
+	Cleanup_DungeonFloor(&state);
+	mu_assert(__func__, Count_BitGridCells(&state.explored_mask) == 0);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_world_glyphs_follow_tiles_and_draw_by_vision() {
+	game_state_t state = Setup_Test_GameStatePlayerAndDungeon();
+	state.player.stats.curr_health = 1000000;
+	const int world_screen_w = Get_WorldScreenWidth();
+	const int world_screen_h = Get_WorldScreenHeight();
+
+	// The glyphs stay in step with the tiles while enemies move, fight and die.
+	for (int turn = 0; turn <= 5; turn++) {
+		for (int x = 0; x < world_screen_w; x++) {
+			for (int y = 0; y < world_screen_h; y++) {
+				const int glyph = (y * world_screen_w) + x;
+				mu_assert(__func__, state.world_glyphs.sprites[glyph] == Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[x][y]));
+				mu_assert(__func__, state.world_glyphs.colours[glyph] == (int)Get_TileForegroundColour(&state.world_tiles[x][y]));
+			}
+		}
+		if (turn == 2 && state.enemy_pool.num_active > 0) {
+			for (int i = 0; i < state.enemy_pool.capacity; i++) {
+				if (Get_PoolEnemy(&state.enemy_pool, i)->is_alive) {
+					Kill_Enemy(&state, i);
+					break;
+				}
+			}
+		}
+		Update_ActiveRegion(&state);
+		Update_FlowField(&state);
+		Update_EnemyTurns(&state);
+	}
+
+	// Only the visible and explored tiles are drawn, the explored ones dimmed. A step aside leaves some explored tiles out of view.
+	Update_FieldOfView(&state);
+	state.player.pos = NewCoord(state.player.pos.x + 1, state.player.pos.y);
+	Update_FieldOfView(&state);
+	GEO_clear_screen();
+	Draw_World(&state);
+	for (int x = 0; x < world_screen_w; x++) {
+		for (int y = 0; y < world_screen_h; y++) {
+			const int glyph = (y * world_screen_w) + x;
+			if (Get_BitGridCell(&state.visible_mask, x, y)) {
+				mu_assert(__func__, GEO_zdk_screen->pixels[y][x] == state.world_glyphs.sprites[glyph]);
+				mu_assert(__func__, GEO_zdk_screen->px_color[y][x] == state.world_glyphs.colours[glyph]);
+			} else if (Get_BitGridCell(&state.explored_mask, x, y)) {
+				mu_assert(__func__, (GEO_zdk_screen->px_color[y][x] & GEO_DIM) != 0);
+			} else {
+				mu_assert(__func__, GEO_zdk_screen->pixels[y][x] == ' ');
+			}
+		}
+	}
+
+	Cleanup_Test_GameStatePlayerAndDungeon(&state);
+	return 0;
+}
+
+int test_game_log_ring_keeps_newest_history() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	// Past its capacity, the log keeps only the newest messages.
+	for (int i = 0; i < LOG_CAPACITY + 904; i++) {
+		Update_GameLog(&state.game_log, "Message %d", i);
+	}
+	mu_assert(__func__, state.game_log.num_lines == LOG_CAPACITY);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), "Message 4999") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), "Message 4995") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, LOG_CAPACITY - 1), "Message 904") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, LOG_CAPACITY), " ") == 0);
+
+	// Paging back twice and down by one message leaves the bottom line a page and a message less one back.
+	const int page_lines = GEO_screen_height() - 4;
+	state.debug_injected_inputs[0] = KEY_PPAGE;
+	state.debug_injected_inputs[1] = KEY_PPAGE;
+	state.debug_injected_inputs[2] = KEY_DOWN;
+	state.debug_injected_inputs[3] = 'l';
+	Draw_LogScreen(&state);
+	char expected_line[LOG_BUFFER_SIZE];
+	snprintf(expected_line, LOG_BUFFER_SIZE, "* Message %d", 4999 - ((page_lines * 2) - 1));
+	mu_assert(__func__, strncmp(GEO_zdk_screen->pixels[GEO_screen_height() - 3], expected_line, strlen(expected_line)) == 0);
+	mu_assert(__func__, state.debug_injected_input_pos == 4);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_game_log_panel_scrolls_without_blank_entries() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	Update_GameLog(&state.game_log, "first");
+	Update_GameLog(&state.game_log, "second");
+	mu_assert(__func__, strcmp(Get_GameLogPanelLine(&state.game_log, 0), "second") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogPanelLine(&state.game_log, 1), "first") == 0);
+
+	// Quiet turns scroll blank rows into the panel until it is empty, but the history only holds the real messages.
+	for (int i = 0; i < LOG_LINES_SHOWN + 3; i++) {
+		Scroll_GameLogPanel(&state.game_log);
+	}
+	for (int row = 0; row < LOG_LINES_SHOWN; row++) {
+		mu_assert(__func__, strcmp(Get_GameLogPanelLine(&state.game_log, row), " ") == 0);
+	}
+	mu_assert(__func__, state.game_log.num_lines == 2);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), "second") == 0);
+	mu_assert(__func__, Get_GameLogEventStats(&state.game_log, LogEvent_EMPTY_SPACE).count == 0);
+
+	// A new message scrolls in above the blank rows, and a quiet turn moves it up by one.
+	Update_GameLog(&state.game_log, "third");
+	Scroll_GameLogPanel(&state.game_log);
+	mu_assert(__func__, strcmp(Get_GameLogPanelLine(&state.game_log, 0), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogPanelLine(&state.game_log, 1), "third") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogPanelLine(&state.game_log, 2), " ") == 0);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_game_log_events_formatted_lazily_with_stats() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+
+	Log_GameEvent(&state.game_log, LogEvent_PLR_GET_GOLD_PLURAL, 7);
+	Log_GameEvent(&state.game_log, LogEvent_PLR_DMG_ENEMY, GetEnemyData(EnmySlug_ZOMBIE)->name, 3);
+	Log_GameEvent(&state.game_log, LogEvent_PLR_GET_GOLD_SINGLE, 1);
+	Log_GameEvent(&state.game_log, LogEvent_PLR_DMG_ENEMY, GetEnemyData(EnmySlug_WEREWOLF)->name, 2);
+
+	// Nothing is formatted until it is read.
+	mu_assert(__func__, !Get_GameLogEntry(&state.game_log, 0)->formatted);
+	mu_assert(__func__, Get_GameLogEntry(&state.game_log, 0)->event == LogEvent_PLR_DMG_ENEMY);
+	mu_assert(__func__, Get_GameLogEntry(&state.game_log, 0)->args[1].number == 2);
+	mu_assert(__func__, Get_GameLogEntry(&state.game_log, 4) == NULL);
+
+	char expected_line[LOG_BUFFER_SIZE];
+	snprintf(expected_line, LOG_BUFFER_SIZE, LOGMSG_PLR_DMG_ENEMY, GetEnemyData(EnmySlug_ZOMBIE)->name, 3);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), expected_line) == 0);
+	mu_assert(__func__, Get_GameLogEntry(&state.game_log, 2)->formatted);
+	mu_assert(__func__, !Get_GameLogEntry(&state.game_log, 3)->formatted);
+	snprintf(expected_line, LOG_BUFFER_SIZE, LOGMSG_PLR_GET_GOLD_PLURAL, 7);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), expected_line) == 0);
+
+	// Stats come from running totals, so they outlast the history.
+	for (int i = 0; i < LOG_CAPACITY; i++) {
+		Log_GameEvent(&state.game_log, LogEvent_EMPTY_SPACE);
+	}
+	const log_event_stats_t damage = Get_GameLogEventStats(&state.game_log, LogEvent_PLR_DMG_ENEMY);
+	const log_event_stats_t gold = Get_GameLogEventStats(&state.game_log, LogEvent_PLR_GET_GOLD_PLURAL);
+	mu_assert(__func__, damage.count == 2 && damage.total == 5);
+	mu_assert(__func__, gold.count == 1 && gold.total == 7);
+	mu_assert(__func__, Get_GameLogEventStats(&state.game_log, LogEvent_PLR_GET_GOLD_SINGLE).total == 1);
+	mu_assert(__func__, Get_GameLogEventStats(&state.game_log, LogEvent_EMPTY_SPACE).count == LOG_CAPACITY);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, LOG_CAPACITY - 1), " ") == 0);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
+int test_session_log_writes_every_entry_or_counts_it_dropped() {
+	game_state_t state = Setup_Test_GameStateAndPlayer();
+	const char *filename = "test_session_log.txt";
+
+	session_log_t session_log;
+	mu_assert(__func__, Init_SessionLog(&session_log, filename, SESSION_LOG_CAPACITY) == true);
+	state.game_log.session_log = &session_log;
+	Log_GameEvent(&state.game_log, LogEvent_PLR_DMG_ENEMY, GetEnemyData(EnmySlug_ZOMBIE)->name, 3);
+	Update_GameLog(&state.game_log, "free text %d", 42);
+	const session_turn_t turn = { .turn = 7, .floor = 2, .health = 5, .max_health = 10, .gold = 3, .x = 4, .y = 6, .enemies_awake = 1 };
+	mu_assert(__func__, Push_SessionLogTurn(&session_log, &turn) == true);
+	Cleanup_SessionLog(&session_log);
+	state.game_log.session_log = NULL;
+
+	// Cleaning up waits for every entry to be written, in the order pushed.
+	char expected_line[LOG_BUFFER_SIZE];
+	snprintf(expected_line, LOG_BUFFER_SIZE, LOGMSG_PLR_DMG_ENEMY, GetEnemyData(EnmySlug_ZOMBIE)->name, 3);
+	char line[SESSION_LOG_LINE_SIZE];
+	FILE *fp = fopen(filename, "r");
+	mu_assert(__func__, fp != NULL);
+	mu_assert(__func__, fgets(line, sizeof(line), fp) != NULL && strncmp(line, expected_line, strlen(expected_line)) == 0);
+	mu_assert(__func__, fgets(line, sizeof(line), fp) != NULL && strcmp(line, "free text 42\n") == 0);
+	mu_assert(__func__, fgets(line, sizeof(line), fp) != NULL && strcmp(line, "-- turn 7, floor 2: health 5/10, gold 3, at (4, 6), 1 enemies awake --\n") == 0);
+	mu_assert(__func__, fgets(line, sizeof(line), fp) == NULL);
+	fclose(fp);
+
+	// A tiny queue fills faster than it drains. Pushing never waits: whatever doesn't fit is dropped, and the file says how many were.
+	const int num_pushed = 2000;
+	int num_queued = 0;
+	mu_assert(__func__, Init_SessionLog(&session_log, filename, 4) == true);
+	for (int i = 0; i < num_pushed; i++) {
+		num_queued += Push_SessionLogText(&session_log, "x") ? 1 : 0;
+	}
+	const unsigned int num_dropped = Get_SessionLogDropped(&session_log);
+	mu_assert(__func__, num_queued + (int)num_dropped == num_pushed);
+	Cleanup_SessionLog(&session_log);
+
+	int num_written = 0;
+	unsigned int num_noted_dropped = 0;
+	unsigned int num_noted;
+	fp = fopen(filename, "r");
+	mu_assert(__func__, fp != NULL);
+	while (fgets(line, sizeof(line), fp) != NULL) {
+		if (sscanf(line, "-- %u records dropped", &num_noted) == 1) {
+			num_noted_dropped += num_noted;
+		} else {
+			mu_assert(__func__, strcmp(line, "x\n") == 0);
+			num_written++;
+		}
+	}
+	fclose(fp);
+	mu_assert(__func__, num_written == num_queued);
+	mu_assert(__func__, num_noted_dropped == num_dropped);
+	remove(filename);
+
+	Cleanup_Test_GameStateAndPlayer(&state);
+	return 0;
+}
+
 int test_addto_player_health_correct_return_values() {
 	game_state_t state = Setup_Test_GameStateAndPlayer();
 
@@ -326,7 +1433,7 @@ int test_set_player_pos_out_of_bounds() {
 int test_set_player_pos_into_solid_fails() {
 	game_state_t state = Setup_Test_GameStateAndPlayer();
 
-	Update_WorldTile(state.world_tiles, NewCoord(0, 0), GetTileData(TileSlug_WALL));
+	Update_WorldTile(&state, NewCoord(0, 0), GetTileData(TileSlug_WALL));
 	mu_assert(__func__, state.world_tiles[0][0].data->type == TileType_SOLID);
 	mu_assert(__func__, Try_SetPlayerPos(&state, NewCoord(0, 0)) == false);
 
@@ -338,42 +1445,42 @@ int test_update_game_log_normal_behaviour() {
 	game_state_t state = Setup_Test_GameStateAndPlayer();
 
 	Update_GameLog(&state.game_log, "Hello");
-	mu_assert(__func__, strcmp(state.game_log.line5, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line4, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line3, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line2, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line1, "Hello") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 1), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), "Hello") == 0);
 
 	Update_GameLog(&state.game_log, "World");
-	mu_assert(__func__, strcmp(state.game_log.line5, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line4, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line3, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line2, "Hello") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line1, "World") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 1), "Hello") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), "World") == 0);
 
 	Update_GameLog(&state.game_log, " ");
-	mu_assert(__func__, strcmp(state.game_log.line5, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line4, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line3, "Hello") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line2, "World") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line1, " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), "Hello") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 1), "World") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), " ") == 0);
 
 	Update_GameLog(&state.game_log, "Test");
 	Update_GameLog(&state.game_log, " ");
-	mu_assert(__func__, strcmp(state.game_log.line5, "Hello") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line4, "World") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line3, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line2, "Test") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line1, " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), "Hello") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), "World") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 1), "Test") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), " ") == 0);
 
 	Update_GameLog(&state.game_log, "abc");
 	Update_GameLog(&state.game_log, "def");
 
-	mu_assert(__func__, strcmp(state.game_log.line5, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line4, "Test") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line3, " ") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line2, "abc") == 0);
-	mu_assert(__func__, strcmp(state.game_log.line1, "def") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 4), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 3), "Test") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 2), " ") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 1), "abc") == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), "def") == 0);
 
 	Cleanup_Test_GameStateAndPlayer(&state);
 	return 0;
@@ -387,7 +1494,7 @@ int test_update_game_log_buffer_overflow_clamped() {
 
 	Update_GameLog(&state.game_log, long_string);
 
-	mu_assert(__func__, strlen(state.game_log.line1) == LOG_BUFFER_SIZE - 1);
+	mu_assert(__func__, strlen(Get_GameLogLine(&state.game_log, 0)) == LOG_BUFFER_SIZE - 1);
 
 	Cleanup_Test_GameStateAndPlayer(&state);
 	return 0;
@@ -404,7 +1511,7 @@ int test_drop_an_item_successfully() {
 	char expected_result[LOG_BUFFER_SIZE];
 	snprintf(expected_result, LOG_BUFFER_SIZE, LOGMSG_PLR_DROP_ITEM, item->name);
 
-	mu_assert(__func__, strcmp(state.game_log.line1, expected_result) == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), expected_result) == 0);
 	mu_assert(__func__, WorldTile_Item_IsEqualTo(&state, NewCoord(0, 0), item) == true);
 
 	Cleanup_Test_GameStateAndPlayer(&state);
@@ -422,7 +1529,7 @@ int test_cant_drop_item_onto_another() {
 	state.player.current_item_index_selected = 1;
 	Interact_CurrentlySelectedItem(&state, ItmCtrl_DROP);
 
-	mu_assert(__func__, strcmp(state.game_log.line1, LOGMSG_PLR_CANT_DROP_ITEM) == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), LOGMSG_PLR_CANT_DROP_ITEM) == 0);
 	mu_assert(__func__, state.player.inventory[0] == GetItem(ItmSlug_NONE));
 	mu_assert(__func__, state.player.inventory[1] == GetItem(ItmSlug_SMALLFOOD));
 
@@ -437,7 +1544,7 @@ int test_pickup_an_item_successfully() {
 
 	// Spawn item next to player.
 	state.player.pos = NewCoord(0, 0);
-	Update_WorldTileItemOccupier(state.world_tiles, NewCoord(0, 1), item);
+	Update_WorldTileItemOccupier(&state, NewCoord(0, 1), item);
 
 	// Set player input to move into the item, then process one game turn.
 	state.debug_injected_inputs[0] = KEY_DOWN;
@@ -449,7 +1556,7 @@ int test_pickup_an_item_successfully() {
 	// Assert item has been picked up and removed from world.
 	mu_assert(__func__, state.player.inventory[0] == item);
 	mu_assert(__func__, WorldTile_Item_IsEqualTo(&state, NewCoord(0, 1), NULL) == true);
-	mu_assert(__func__, strcmp(state.game_log.line1, expected_logmsg_result) == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), expected_logmsg_result) == 0);
 
 	Cleanup_Test_GameStateAndPlayer(&state);
 	return 0;
@@ -463,11 +1570,11 @@ int test_item_examine_correct_value() {
 
 	state.player.current_item_index_selected = 0;
 	Interact_CurrentlySelectedItem(&state, ItmCtrl_EXAMINE);
-	mu_assert(__func__, strcmp(state.game_log.line1, LOGMSG_EXAMINE_SMALL_FOOD) == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), LOGMSG_EXAMINE_SMALL_FOOD) == 0);
 
 	state.player.current_item_index_selected = 1;
 	Interact_CurrentlySelectedItem(&state, ItmCtrl_EXAMINE);
-	mu_assert(__func__, strcmp(state.game_log.line1, LOGMSG_EXAMINE_BIG_FOOD) == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), LOGMSG_EXAMINE_BIG_FOOD) == 0);
 
 	Cleanup_Test_GameStateAndPlayer(&state);
 	return 0;
@@ -485,14 +1592,14 @@ int test_cant_pickup_another_item_because_inventory_full() {
 
 	// Spawn item next to player.
 	state.player.pos = NewCoord(0, 0);
-	Update_WorldTileItemOccupier(state.world_tiles, NewCoord(0, 1), item);
+	Update_WorldTileItemOccupier(&state, NewCoord(0, 1), item);
 
 	// Set player input to move into the item, then process one game turn.
 	state.debug_injected_inputs[0] = KEY_DOWN;
 	Process(&state);
 
 	// Assert the player has tried but failed to pick up the item.
-	mu_assert(__func__, strcmp(state.game_log.line1, LOGMSG_PLR_INVENTORY_FULL) == 0);
+	mu_assert(__func__, strcmp(Get_GameLogLine(&state.game_log, 0), LOGMSG_PLR_INVENTORY_FULL) == 0);
 	mu_assert(__func__, WorldTile_Item_IsEqualTo(&state, NewCoord(0, 1), item) == true);
 
 	Cleanup_Test_GameStateAndPlayer(&state);
@@ -505,15 +1612,15 @@ int test_get_tile_foreground_attributes_no_occupiers() {
 	const tile_data_t random_tile1 = {.sprite = 'X', .type = TileType_SOLID, .color = Clr_CYAN};
 	const tile_data_t random_tile2 = {.sprite = 'Q', .type = TileType_NPC, .color = Clr_MAGENTA};
 
-	Update_WorldTile(state.world_tiles, NewCoord(0, 0), &random_tile1);
+	Update_WorldTile(&state, NewCoord(0, 0), &random_tile1);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == 'X');
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == 'X');
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_SOLID);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_CYAN);
 
-	Update_WorldTile(state.world_tiles, NewCoord(0, 0), &random_tile2);
+	Update_WorldTile(&state, NewCoord(0, 0), &random_tile2);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == 'Q');
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == 'Q');
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_NPC);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_MAGENTA);
 
@@ -524,21 +1631,21 @@ int test_get_tile_foreground_attributes_no_occupiers() {
 int test_get_tile_foreground_attributes_single_occupier() {
 	game_state_t state = Setup_Test_GameStateAndPlayer();
 
-	enemy_t *enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_WEREWOLF), NewCoord(1, 1));
+	const int enemy = Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(1, 1));
 	const item_t *item = GetItem(ItmSlug_BIGFOOD);
 	const tile_data_t random_tile1 = {.sprite = 'X', .type = TileType_SOLID, .color = Clr_CYAN};
 
-	Update_WorldTile(state.world_tiles, NewCoord(0, 0), &random_tile1);
-	Update_WorldTileItemOccupier(state.world_tiles, NewCoord(0, 0), item);
+	Update_WorldTile(&state, NewCoord(0, 0), &random_tile1);
+	Update_WorldTileItemOccupier(&state, NewCoord(0, 0), item);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == item->sprite);
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == item->sprite);
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_ITEM);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_GREEN);
 
-	Update_WorldTileItemOccupier(state.world_tiles, NewCoord(0, 0), NULL);
-	Update_WorldTileEnemyOccupier(state.world_tiles, NewCoord(0, 0), enemy);
+	Update_WorldTileItemOccupier(&state, NewCoord(0, 0), NULL);
+	Update_WorldTileEnemyOccupier(&state, NewCoord(0, 0), enemy);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == enemy->data->sprite);
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == GetEnemyData(EnmySlug_WEREWOLF)->sprite);
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_ENEMY);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_RED);
 
@@ -549,29 +1656,29 @@ int test_get_tile_foreground_attributes_single_occupier() {
 int test_get_tile_foreground_attributes_full_occupiers() {
 	game_state_t state = Setup_Test_GameStateAndPlayer();
 
-	enemy_t *enemy = InitCreate_Enemy(GetEnemyData(EnmySlug_WEREWOLF), NewCoord(0, 0));
+	const int enemy = Spawn_Enemy(&state, GetEnemyData(EnmySlug_WEREWOLF), NewCoord(0, 0));
 	const item_t *item = GetItem(ItmSlug_BIGFOOD);
 	const tile_data_t random_tile1 = {.sprite = 'X', .type = TileType_SOLID, .color = Clr_CYAN};
 
 	// Priority ordering: Enemy > Item > Tile.
 
-	Update_WorldTile(state.world_tiles, NewCoord(0, 0), &random_tile1);
-	Update_WorldTileEnemyOccupier(state.world_tiles, NewCoord(0, 0), enemy);
-	Update_WorldTileItemOccupier(state.world_tiles, NewCoord(0, 0), item);
+	Update_WorldTile(&state, NewCoord(0, 0), &random_tile1);
+	Update_WorldTileEnemyOccupier(&state, NewCoord(0, 0), enemy);
+	Update_WorldTileItemOccupier(&state, NewCoord(0, 0), item);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == enemy->data->sprite);
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == GetEnemyData(EnmySlug_WEREWOLF)->sprite);
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_ENEMY);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_RED);
 
-	Update_WorldTileEnemyOccupier(state.world_tiles, NewCoord(0, 0), NULL);
+	Update_WorldTileEnemyOccupier(&state, NewCoord(0, 0), ENEMY_NONE);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == item->sprite);
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == item->sprite);
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_ITEM);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_GREEN);
 
-	Update_WorldTileItemOccupier(state.world_tiles, NewCoord(0, 0), NULL);
+	Update_WorldTileItemOccupier(&state, NewCoord(0, 0), NULL);
 
-	mu_assert(__func__, Get_TileForegroundSprite(&state.world_tiles[0][0]) == 'X');
+	mu_assert(__func__, Get_TileForegroundSprite(&state.enemy_pool, &state.world_tiles[0][0]) == 'X');
 	mu_assert(__func__, Get_TileForegroundType(&state.world_tiles[0][0]) == TileType_SOLID);
 	mu_assert(__func__, Get_TileForegroundColour(&state.world_tiles[0][0]) == Clr_CYAN);
 
@@ -583,12 +1690,40 @@ int run_all_tests() {
 	mu_run_test(test_init_game_state_correct_values);
 	mu_run_test(test_create_player_correct_values);
 	mu_run_test(test_init_create_enemy_correct_values);
+	mu_run_test(test_enemy_pool_reuses_slots_and_resets);
+	mu_run_test(test_killed_enemies_removed_and_slots_reused);
+	mu_run_test(test_floor_arena_reset_between_floors);
+	mu_run_test(test_enemies_follow_flow_field_to_player);
+	mu_run_test(test_active_region_wakes_only_nearby_enemies);
+	mu_run_test(test_scheduler_pops_due_actors_in_time_order);
+	mu_run_test(test_enemies_attack_only_with_their_own_actions);
+	mu_run_test(test_enemy_turns_identical_across_planner_threads);
+	mu_run_test(test_spatial_hash_queries_match_world);
+	mu_run_test(test_find_path_shortest_around_walls);
+	mu_run_test(test_field_of_view_blocked_by_walls_and_symmetric);
+	mu_run_test(test_explored_tiles_remembered_out_of_view);
+	mu_run_test(test_world_glyphs_follow_tiles_and_draw_by_vision);
+	mu_run_test(test_game_log_ring_keeps_newest_history);
+	mu_run_test(test_game_log_panel_scrolls_without_blank_entries);
+	mu_run_test(test_game_log_events_formatted_lazily_with_stats);
+	mu_run_test(test_session_log_writes_every_entry_or_counts_it_dropped);
 
 	mu_run_test(test_get_world_width_correct_value);
 	mu_run_test(test_get_world_height_correct_value);
 
 	mu_run_test(test_created_dungeon_floor_contains_staircase);
 	mu_run_test(test_created_dungeon_floor_contains_player);
+	mu_run_test(test_created_cave_floor_contains_staircase_and_player);
+	mu_run_test(test_created_bsp_floor_contains_all_rooms_specified);
+	mu_run_test(test_seeded_dungeon_floors_are_identical);
+	mu_run_test(test_created_dungeon_floors_staircase_reachable);
+	mu_run_test(test_validate_floor_connectivity_correct_values);
+	mu_run_test(test_bitgrid_automaton_correct_values);
+	mu_run_test(test_open_map_file_correct_extents);
+	mu_run_test(test_created_floor_from_template_correct_positions);
+	mu_run_test(test_compiled_map_template_matches_source);
+	mu_run_test(test_sprite_decoding_matches_databases);
+	mu_run_test(test_prefab_library_stamped_into_floors);
 
 	mu_run_test(test_addto_player_health_correct_return_values);
 	mu_run_test(test_addto_player_health_correct_current_health);
@@ -622,7 +1757,7 @@ floor_statistics_t get_statistics_on_dungeon_floor_creation(int iterations) {
 	int most_rooms = MIN_ROOMS;
 
 	for (int i = 0; i < iterations; i++) {
-		InitCreate_DungeonFloor(&state, MAX_ROOMS, NULL);
+		InitCreate_DungeonFloor(&state, MAX_ROOMS, FloorLayout_ROOMS, NULL);
 		total_rooms += state.num_rooms_created;
 		state.current_floor++;
 
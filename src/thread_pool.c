@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <assert.h>
+#include "thread_pool.h"
+
+/*
+	Runs the current task over the 'slice'th share of its items.
+*/
+static void Run_ThreadPoolSlice(thread_pool_t *pool, thread_pool_task_fn task, void *context, int num_items, int slice) {
+	const int begin = (int)(((long long)num_items * slice) / pool->num_threads);
+	const int end = (int)(((long long)num_items * (slice + 1)) / pool->num_threads);
+	if (begin < end) {
+		task(context, begin, end);
+	}
+}
+
+/*
+	Worker thread loop: waits for each new task, runs its slice, and reports back until the pool shuts down.
+*/
+static void* Run_ThreadPoolWorker(void *arg) {
+	thread_pool_worker_t *worker = arg;
+	thread_pool_t *pool = worker->pool;
+	unsigned int seen_generation = 0;
+
+	pthread_mutex_lock(&pool->lock);
+	while (true) {
+		while (pool->task_generation == seen_generation && !pool->shutting_down) {
+			pthread_cond_wait(&pool->task_ready, &pool->lock);
+		}
+		if (pool->shutting_down) {
+			break;
+		}
+
+		seen_generation = pool->task_generation;
+		const thread_pool_task_fn task = pool->task;
+		void *context = pool->context;
+		const int num_items = pool->num_items;
+		pthread_mutex_unlock(&pool->lock);
+
+		Run_ThreadPoolSlice(pool, task, context, num_items, worker->slice);
+
+		pthread_mutex_lock(&pool->lock);
+		if (--pool->num_pending == 0) {
+			pthread_cond_signal(&pool->task_done);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return NULL;
+}
+
+void Init_ThreadPool(thread_pool_t *pool, int num_threads) {
+	assert(pool != NULL);
+	assert(num_threads >= 1);
+
+	pool->num_threads = num_threads;
+	pool->task_generation = 0;
+	pool->num_pending = 0;
+	pool->shutting_down = false;
+	pool->task = NULL;
+	pool->context = NULL;
+	pool->num_items = 0;
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->task_ready, NULL);
+	pthread_cond_init(&pool->task_done, NULL);
+
+	// The calling thread always runs the first slice itself.
+	pool->threads = malloc(sizeof(*pool->threads) * num_threads);
+	assert(pool->threads != NULL);
+	pool->workers = malloc(sizeof(*pool->workers) * num_threads);
+	assert(pool->workers != NULL);
+	for (int i = 1; i < num_threads; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].slice = i;
+
+		// If a worker can't be started, tasks are split among the threads that did start (down to the calling thread alone).
+		if (pthread_create(&pool->threads[i], NULL, Run_ThreadPoolWorker, &pool->workers[i]) != 0) {
+			pool->num_threads = i;
+			break;
+		}
+	}
+}
+
+void Cleanup_ThreadPool(thread_pool_t *pool) {
+	assert(pool != NULL);
+
+	pthread_mutex_lock(&pool->lock);
+	pool->shutting_down = true;
+	pthread_cond_broadcast(&pool->task_ready);
+	pthread_mutex_unlock(&pool->lock);
+
+	for (int i = 1; i < pool->num_threads; i++) {
+		pthread_join(pool->threads[i], NULL);
+	}
+
+	pthread_cond_destroy(&pool->task_done);
+	pthread_cond_destroy(&pool->task_ready);
+	pthread_mutex_destroy(&pool->lock);
+	free(pool->threads);
+	free(pool->workers);
+}
+
+void Run_ThreadPool(thread_pool_t *pool, thread_pool_task_fn task, void *context, int num_items) {
+	assert(pool != NULL);
+	assert(task != NULL);
+	assert(num_items >= 0);
+
+	if (pool->num_threads == 1) {
+		Run_ThreadPoolSlice(pool, task, context, num_items, 0);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	pool->task = task;
+	pool->context = context;
+	pool->num_items = num_items;
+	pool->num_pending = pool->num_threads - 1;
+	pool->task_generation++;
+	pthread_cond_broadcast(&pool->task_ready);
+	pthread_mutex_unlock(&pool->lock);
+
+	Run_ThreadPoolSlice(pool, task, context, num_items, 0);
+
+	pthread_mutex_lock(&pool->lock);
+	while (pool->num_pending > 0) {
+		pthread_cond_wait(&pool->task_done, &pool->lock);
+	}
+	pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,50 @@
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <stdbool.h>
+#include <pthread.h>
+
+/*
+	A task run over the items from 'begin' up to (not including) 'end'. Tasks run on separate threads at once, so each must only write to its own items.
+*/
+typedef void (*thread_pool_task_fn)(void *context, int begin, int end);
+
+typedef struct thread_pool_worker_t {
+	struct thread_pool_t *pool;
+	int slice;					// Which share of every task's items this worker runs.
+} thread_pool_worker_t;
+
+typedef struct thread_pool_t {
+	int num_threads;			// Threads sharing each task, including the calling thread.
+	pthread_t *threads;			// The 'num_threads' - 1 workers, which wait between tasks.
+	thread_pool_worker_t *workers;
+	pthread_mutex_t lock;
+	pthread_cond_t task_ready;
+	pthread_cond_t task_done;
+	unsigned int task_generation;	// Increases with every task, so workers know when a new one is ready.
+	int num_pending;				// Workers yet to finish the current task.
+	bool shutting_down;
+
+	thread_pool_task_fn task;
+	void *context;
+	int num_items;
+} thread_pool_t;
+
+/*
+	Starts a pool that splits each task across 'num_threads' threads (at least 1), the calling thread being one of them.
+	A pool of 1 thread starts no threads and runs every task directly. If some threads can't be started, the pool shrinks to those that did.
+*/
+void Init_ThreadPool(thread_pool_t *pool, int num_threads);
+
+/*
+	Stops and joins every worker thread.
+*/
+void Cleanup_ThreadPool(thread_pool_t *pool);
+
+/*
+	Runs 'task' over items 0 to 'num_items' - 1 and returns once all of them are done.
+	The items are split into one contiguous slice per thread, so which thread runs an item depends only on the item count.
+*/
+void Run_ThreadPool(thread_pool_t *pool, thread_pool_task_fn task, void *context, int num_items);
+
+#endif // !THREAD_POOL_H_
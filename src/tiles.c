@@ -1,16 +1,33 @@
 #include "tiles.h"
+#include "ascii_game.h"
 
 static const tile_data_t g_tile_data_database[] = {
-	[TileSlug_VOID] = {.sprite = SPR_VOID, .type = TileType_EMPTY, .color = Clr_MAGENTA},
-	[TileSlug_GROUND] = {.sprite = SPR_GROUND, .type = TileType_EMPTY, .color = Clr_WHITE},
-	[TileSlug_WALL] = {.sprite = SPR_WALL, .type = TileType_SOLID, .color = Clr_WHITE},
-	[TileSlug_GOLD] = {.sprite = SPR_GOLD, .type = TileType_ITEM, .color = Clr_GREEN},
-	[TileSlug_BIGGOLD] = {.sprite = SPR_BIGGOLD, .type = TileType_ITEM, .color = Clr_GREEN},
-	[TileSlug_STAIRCASE] = {.sprite = SPR_STAIRCASE, .type = TileType_SPECIAL, .color = Clr_YELLOW},
-	[TileSlug_OPENING] = {.sprite = SPR_OPENING, .type = TileType_EMPTY, .color = Clr_WHITE},
-	[TileSlug_MERCHANT] = {.sprite = SPR_MERCHANT, .type = TileType_NPC, .color = Clr_MAGENTA}
+#define TILE_DATABASE_ENTRY(name, sprite_, type_, colour) [TileSlug_##name] = {.sprite = SPR_##name, .type = (type_), .color = (colour)},
+	TILE_DATABASE(TILE_DATABASE_ENTRY)
+#undef TILE_DATABASE_ENTRY
 };
 
+#define TILE_DECODING_ENTRY(name, sprite, type, colour) [(unsigned char)(sprite)] = {.tile_slug = TileSlug_##name, .item_slug = ItmSlug_NONE},
+#define ITEM_DECODING_ENTRY(name, sprite, display_name, value) [(unsigned char)(sprite)] = {.tile_slug = TileSlug_GROUND, .item_slug = ItmSlug_##name},
+#define ENEMY_DECODING_ENTRY(name, sprite, display_name, max_health, speed) [(unsigned char)(sprite)] = {.tile_slug = TileSlug_GROUND, .item_slug = ItmSlug_NONE, .enemy_slug = EnmySlug_##name, .is_enemy = true},
+
+// Every sprite defaults to ground, then each database's entries override their own sprite (which GCC would otherwise warn about).
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Woverride-init"
+static const sprite_decoding_t g_sprite_decoding_table[256] = {
+	[0 ... 255] = {.tile_slug = TileSlug_GROUND, .item_slug = ItmSlug_NONE},
+	TILE_DATABASE(TILE_DECODING_ENTRY)
+	ITEM_DATABASE(ITEM_DECODING_ENTRY)
+	ENEMY_DATABASE(ENEMY_DECODING_ENTRY)
+	[(unsigned char)SPR_PLAYER] = {.tile_slug = TileSlug_GROUND, .item_slug = ItmSlug_NONE, .is_player = true},
+	[(unsigned char)_UNITY_VOID_SPRITE] = {.tile_slug = TileSlug_VOID, .item_slug = ItmSlug_NONE}
+};
+#pragma GCC diagnostic pop
+
 const tile_data_t* GetTileData(const tile_slug_en tile_slug) {
 	return &g_tile_data_database[tile_slug];
+}
+
+const sprite_decoding_t* GetSpriteDecoding(const char sprite) {
+	return &g_sprite_decoding_table[(unsigned char)sprite];
 }
\ No newline at end of file
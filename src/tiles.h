@@ -5,26 +5,32 @@
 #include "enemies.h"
 #include "colours.h"
 
-#define SPR_VOID '.'		
-#define SPR_GROUND ' '		
-#define SPR_WALL '#'
-#define SPR_OPENING '?'		// Used to mark openings in rooms.
-#define SPR_STAIRCASE '^'
-#define SPR_MERCHANT '1'
-#define SPR_GOLD 'g'
-#define SPR_BIGGOLD 'G'
+/*
+	Every tile in the game as X(name, sprite, type, colour). Each entry defines the tile's slug (TileSlug_name), its sprite (SPR_name),
+	its entry in the tile data database and how its sprite is decoded from map files, so a new tile only needs a new entry here.
+*/
+#define TILE_DATABASE(X) \
+	X(VOID,			'.',	TileType_EMPTY,		Clr_MAGENTA) \
+	X(GROUND,		' ',	TileType_EMPTY,		Clr_WHITE) \
+	X(WALL,			'#',	TileType_SOLID,		Clr_WHITE) \
+	X(GOLD,			'g',	TileType_ITEM,		Clr_GREEN) \
+	X(BIGGOLD,		'G',	TileType_ITEM,		Clr_GREEN) \
+	X(STAIRCASE,	'^',	TileType_SPECIAL,	Clr_YELLOW) \
+	X(OPENING,		'?',	TileType_EMPTY,		Clr_WHITE)		/* Used to mark openings in rooms. */ \
+	X(MERCHANT,		'1',	TileType_NPC,		Clr_MAGENTA)
+
+#define TILE_SLUG_ENTRY(name, sprite, type, colour) TileSlug_##name,
+#define TILE_SPRITE_ENTRY(name, sprite, type, colour) SPR_##name = (sprite),
 
 typedef enum tile_slug_en {
-	TileSlug_VOID,
-	TileSlug_GROUND,
-	TileSlug_WALL,
-	TileSlug_GOLD,
-	TileSlug_BIGGOLD,
-	TileSlug_STAIRCASE,
-	TileSlug_OPENING,
-	TileSlug_MERCHANT
+	TILE_DATABASE(TILE_SLUG_ENTRY)
+	TileSlug_COUNT			// Number of tile slugs (not a tile).
 } tile_slug_en;
 
+typedef enum tile_sprite_en {
+	TILE_DATABASE(TILE_SPRITE_ENTRY)
+} tile_sprite_en;
+
 typedef enum tile_type_en {
 	TileType_NPC,
 	TileType_ENEMY,
@@ -42,13 +48,27 @@ typedef struct tile_data_t {
 
 typedef struct tile_t {
 	const tile_data_t *data;
-	enemy_t *enemy_occupier;
+	int enemy_occupier;			// Index of the enemy on this tile in the floor's enemy pool (ENEMY_NONE if there is none).
 	const item_t *item_occupier;
 } tile_t;
 
+typedef struct sprite_decoding_t {
+	tile_slug_en tile_slug;		// Tile beneath the sprite (ground for sprites of items, enemies and the player).
+	item_slug_en item_slug;		// ItmSlug_NONE unless the sprite is an item.
+	enemy_slug_en enemy_slug;	// Only valid if 'is_enemy' is set.
+	bool is_enemy;
+	bool is_player;
+} sprite_decoding_t;
+
 /*
 	Returns a pointer to the tile data from the global tile data database (defined in tiles.c) that matches the 'tile_slug' arg.
 */
 const tile_data_t* GetTileData(tile_slug_en tile_slug);
 
+/*
+	Returns how a sprite read from a map file decodes into a tile, item, enemy or the player. Sprites that aren't in any database (e.g. whitespace) decode to ground.
+	This is a single lookup into a 256-entry table (defined in tiles.c) generated at compile time from the tile, item and enemy databases.
+*/
+const sprite_decoding_t* GetSpriteDecoding(char sprite);
+
 #endif /* TILES_H_ */
\ No newline at end of file
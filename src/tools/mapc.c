@@ -0,0 +1,78 @@
+/*
+	mapc - compiles a txt map into the game's compiled binary map format, so it can be loaded without any text parsing.
+
+	Run with: ./mapc <input.txt> <output.map>
+	The compiled map is read back and compared against the txt map before mapc reports success.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "../ascii_game.h"
+
+/*
+	Returns true if both map templates describe exactly the same map.
+*/
+static bool Check_MapTemplatesEqual(const map_template_t *a, const map_template_t *b) {
+	if (a->width != b->width || a->height != b->height || a->num_enemy_spawns != b->num_enemy_spawns
+		|| !CoordsEqual(a->anchor, b->anchor) || !CoordsEqual(a->player_spawn, b->player_spawn) || !CoordsEqual(a->staircase_pos, b->staircase_pos)) {
+		return false;
+	}
+
+	for (int i = 0; i < a->width * a->height; i++) {
+		if (a->tiles[i].data != b->tiles[i].data || a->tiles[i].item_occupier != b->tiles[i].item_occupier) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < a->num_enemy_spawns; i++) {
+		if (a->enemy_spawns[i].data != b->enemy_spawns[i].data || !CoordsEqual(a->enemy_spawns[i].pos, b->enemy_spawns[i].pos)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[]) {
+	if (argc != 3) {
+		fprintf(stderr, "Run with: ./mapc <input.txt> <output.map>\n");
+		return 1;
+	}
+
+	const char *input_filename = argv[1];
+	const char *output_filename = argv[2];
+
+	map_template_t source;
+	if (!Init_MapTemplate(&source, input_filename)) {
+		fprintf(stderr, "mapc: could not read \"%s\"\n", input_filename);
+		return 1;
+	}
+
+	if (!Save_MapTemplate(&source, output_filename)) {
+		fprintf(stderr, "mapc: could not write \"%s\"\n", output_filename);
+		Cleanup_MapTemplate(&source);
+		return 1;
+	}
+
+	map_template_t compiled;
+	const bool verified = Init_MapTemplate(&compiled, output_filename) && Check_MapTemplatesEqual(&source, &compiled);
+	if (!verified) {
+		fprintf(stderr, "mapc: \"%s\" does not match \"%s\" when read back\n", output_filename, input_filename);
+		remove(output_filename);
+		Cleanup_MapTemplate(&compiled);
+		Cleanup_MapTemplate(&source);
+		return 1;
+	}
+
+	struct stat input_stat;
+	struct stat output_stat;
+	stat(input_filename, &input_stat);
+	stat(output_filename, &output_stat);
+	printf("%s -> %s: %dx%d, %d enemy spawn(s), %lld -> %lld bytes\n", input_filename, output_filename,
+		source.width, source.height, source.num_enemy_spawns, (long long)input_stat.st_size, (long long)output_stat.st_size);
+
+	Cleanup_MapTemplate(&compiled);
+	Cleanup_MapTemplate(&source);
+	return 0;
+}
@@ -0,0 +1,275 @@
+/*
+	seed_search - scans a range of seeds across threads and prints those whose dungeon floor matches every constraint given.
+
+	Run with: ./seed_search [options]
+	Matching seeds are streamed to stdout as they are found (not in seed order), one per line with the floor's statistics.
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+#include <limits.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "../george_graphics.h"
+#include "../ascii_game.h"
+#include "../prefabs.h"
+
+#define SEEDS_PER_BATCH 256			// Seeds claimed by a thread at a time.
+#define DEFAULT_WORLD_WIDTH 164
+#define DEFAULT_WORLD_HEIGHT 74
+
+typedef struct floor_profile_t {
+	int rooms;
+	int rcs;
+	int enemies;
+	int gold;
+	int path;						// Steps from the player spawn to the staircase (-1 if unreachable).
+	int area;						// Walkable tiles reachable from the player spawn.
+} floor_profile_t;
+
+typedef struct search_options_t {
+	unsigned int first_seed;
+	unsigned long long num_seeds;
+	int num_threads;
+	int num_rooms;
+	floor_layout_en layout;
+	const prefab_library_t *prefab_library;	// Shared read-only by every thread (NULL for plain rooms only).
+
+	floor_profile_t min;			// Inclusive lower bounds for each statistic.
+	floor_profile_t max;			// Inclusive upper bounds for each statistic.
+} search_options_t;
+
+typedef struct search_shared_t {
+	const search_options_t *options;
+	unsigned long long next_offset;	// Next unclaimed seed, as an offset from 'first_seed'. Claimed atomically.
+	unsigned long long num_matches;
+	pthread_mutex_t output_lock;
+} search_shared_t;
+
+/*
+	Returns true if 'value' lies within the inclusive bounds.
+*/
+static bool Check_InRange(int value, int min, int max) {
+	return value >= min && value <= max;
+}
+
+/*
+	Fills 'profile' with the statistics of the current dungeon floor, stopping early (and returning false) once any constraint fails.
+*/
+static bool Check_FloorMatches(const search_options_t *options, const game_state_t *state, floor_profile_t *profile) {
+	profile->rooms = state->num_rooms_created;
+	profile->rcs = state->debug_rcs;
+	profile->path = state->connectivity.staircase_distance;
+	profile->area = state->connectivity.reachable_area;
+	if (!Check_InRange(profile->rooms, options->min.rooms, options->max.rooms) || !Check_InRange(profile->rcs, options->min.rcs, options->max.rcs)
+		|| !Check_InRange(profile->path, options->min.path, options->max.path) || !Check_InRange(profile->area, options->min.area, options->max.area)) {
+		return false;
+	}
+
+	profile->enemies = state->enemy_pool.num_active;
+	if (!Check_InRange(profile->enemies, options->min.enemies, options->max.enemies)) {
+		return false;
+	}
+
+	profile->gold = 0;
+	for (int x = 0; x < Get_WorldScreenWidth(); x++) {
+		for (int y = 0; y < Get_WorldScreenHeight(); y++) {
+			const tile_data_t *data = state->world_tiles[x][y].data;
+			if (data == GetTileData(TileSlug_GOLD) || data == GetTileData(TileSlug_BIGGOLD)) {
+				profile->gold++;
+			}
+		}
+	}
+	return Check_InRange(profile->gold, options->min.gold, options->max.gold);
+}
+
+/*
+	Thread entry point. Claims batches of seeds until the range is exhausted, generating every floor in its own game state.
+*/
+static void* Search_Seeds(void *arg) {
+	search_shared_t *shared = arg;
+	const search_options_t *options = shared->options;
+
+	game_state_t state;
+	Init_GameState(&state);
+	state.player = Create_Player();
+	state.prefab_library = options->prefab_library;
+
+	while (true) {
+		const unsigned long long batch_start = __atomic_fetch_add(&shared->next_offset, SEEDS_PER_BATCH, __ATOMIC_RELAXED);
+		if (batch_start >= options->num_seeds) {
+			break;
+		}
+
+		const unsigned long long batch_end = (batch_start + SEEDS_PER_BATCH < options->num_seeds) ? batch_start + SEEDS_PER_BATCH : options->num_seeds;
+		for (unsigned long long offset = batch_start; offset < batch_end; offset++) {
+			const unsigned int seed = options->first_seed + (unsigned int)offset;
+			floor_profile_t profile;
+
+			Seed_GameState(&state, seed);
+			InitCreate_DungeonFloor(&state, options->num_rooms, options->layout, NULL);
+
+			if (Check_FloorMatches(options, &state, &profile)) {
+				pthread_mutex_lock(&shared->output_lock);
+				printf("seed=%u rooms=%d rcs=%d enemies=%d gold=%d path=%d area=%d\n",
+					seed, profile.rooms, profile.rcs, profile.enemies, profile.gold, profile.path, profile.area);
+				fflush(stdout);
+				shared->num_matches++;
+				pthread_mutex_unlock(&shared->output_lock);
+			}
+
+			Cleanup_DungeonFloor(&state);
+		}
+	}
+
+	Cleanup_GameState(&state);
+	return NULL;
+}
+
+static void Print_Usage(void) {
+	fprintf(stderr,
+		"Run with: ./seed_search [options]\n"
+		"  --start SEED          first seed to test (default 0)\n"
+		"  --count N             number of seeds to test (default 1000000)\n"
+		"  --threads N           worker threads (default: number of online cores)\n"
+		"  --rooms N             rooms requested per floor (default %d)\n"
+		"  --layout NAME         rooms | bsp | cave (default rooms)\n"
+		"  --prefabs DIR         stamp prefab rooms from DIR (default: plain rooms only)\n"
+		"  --width W --height H  world size (default %dx%d)\n"
+		"  --min-rooms N   --max-rooms N\n"
+		"  --min-rcs N     --max-rcs N\n"
+		"  --min-enemies N --max-enemies N\n"
+		"  --min-gold N    --max-gold N\n"
+		"  --min-path N    --max-path N    steps from spawn to staircase (-1 if unreachable)\n"
+		"  --min-area N    --max-area N    walkable tiles reachable from spawn\n",
+		MAX_ROOMS, DEFAULT_WORLD_WIDTH, DEFAULT_WORLD_HEIGHT);
+}
+
+int main(int argc, char *argv[]) {
+	enum {
+		Opt_START = 256, Opt_COUNT, Opt_THREADS, Opt_ROOMS, Opt_LAYOUT, Opt_PREFABS, Opt_WIDTH, Opt_HEIGHT,
+		Opt_MIN_ROOMS, Opt_MAX_ROOMS, Opt_MIN_RCS, Opt_MAX_RCS, Opt_MIN_ENEMIES, Opt_MAX_ENEMIES,
+		Opt_MIN_GOLD, Opt_MAX_GOLD, Opt_MIN_PATH, Opt_MAX_PATH, Opt_MIN_AREA, Opt_MAX_AREA
+	};
+	static const struct option long_options[] = {
+		{"start", required_argument, NULL, Opt_START}, {"count", required_argument, NULL, Opt_COUNT},
+		{"threads", required_argument, NULL, Opt_THREADS}, {"rooms", required_argument, NULL, Opt_ROOMS},
+		{"layout", required_argument, NULL, Opt_LAYOUT}, {"prefabs", required_argument, NULL, Opt_PREFABS},
+		{"width", required_argument, NULL, Opt_WIDTH}, {"height", required_argument, NULL, Opt_HEIGHT},
+		{"min-rooms", required_argument, NULL, Opt_MIN_ROOMS}, {"max-rooms", required_argument, NULL, Opt_MAX_ROOMS},
+		{"min-rcs", required_argument, NULL, Opt_MIN_RCS}, {"max-rcs", required_argument, NULL, Opt_MAX_RCS},
+		{"min-enemies", required_argument, NULL, Opt_MIN_ENEMIES}, {"max-enemies", required_argument, NULL, Opt_MAX_ENEMIES},
+		{"min-gold", required_argument, NULL, Opt_MIN_GOLD}, {"max-gold", required_argument, NULL, Opt_MAX_GOLD},
+		{"min-path", required_argument, NULL, Opt_MIN_PATH}, {"max-path", required_argument, NULL, Opt_MAX_PATH},
+		{"min-area", required_argument, NULL, Opt_MIN_AREA}, {"max-area", required_argument, NULL, Opt_MAX_AREA},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	search_options_t options = {
+		.first_seed = 0,
+		.num_seeds = 1000000,
+		.num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN),
+		.num_rooms = MAX_ROOMS,
+		.layout = FloorLayout_ROOMS,
+		.prefab_library = NULL,
+		.min = {.rooms = 0, .rcs = 0, .enemies = 0, .gold = 0, .path = INT_MIN, .area = 0},
+		.max = {.rooms = INT_MAX, .rcs = INT_MAX, .enemies = INT_MAX, .gold = INT_MAX, .path = INT_MAX, .area = INT_MAX}
+	};
+	int world_w = DEFAULT_WORLD_WIDTH;
+	int world_h = DEFAULT_WORLD_HEIGHT;
+	const char *prefab_directory = NULL;
+
+	int opt;
+	while ((opt = getopt_long(argc, argv, "h", long_options, NULL)) != -1) {
+		switch (opt) {
+			case Opt_START: options.first_seed = (unsigned int)strtoul(optarg, NULL, 0); break;
+			case Opt_COUNT: options.num_seeds = strtoull(optarg, NULL, 0); break;
+			case Opt_THREADS: options.num_threads = (int)strtol(optarg, NULL, 0); break;
+			case Opt_ROOMS: options.num_rooms = (int)strtol(optarg, NULL, 0); break;
+			case Opt_WIDTH: world_w = (int)strtol(optarg, NULL, 0); break;
+			case Opt_HEIGHT: world_h = (int)strtol(optarg, NULL, 0); break;
+			case Opt_PREFABS: prefab_directory = optarg; break;
+			case Opt_LAYOUT:
+				if (strcmp(optarg, "rooms") == 0) {
+					options.layout = FloorLayout_ROOMS;
+				} else if (strcmp(optarg, "bsp") == 0) {
+					options.layout = FloorLayout_BSP;
+				} else if (strcmp(optarg, "cave") == 0) {
+					options.layout = FloorLayout_CAVE;
+				} else {
+					Print_Usage();
+					return 1;
+				}
+				break;
+			case Opt_MIN_ROOMS: options.min.rooms = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MAX_ROOMS: options.max.rooms = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MIN_RCS: options.min.rcs = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MAX_RCS: options.max.rcs = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MIN_ENEMIES: options.min.enemies = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MAX_ENEMIES: options.max.enemies = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MIN_GOLD: options.min.gold = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MAX_GOLD: options.max.gold = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MIN_PATH: options.min.path = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MAX_PATH: options.max.path = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MIN_AREA: options.min.area = (int)strtol(optarg, NULL, 0); break;
+			case Opt_MAX_AREA: options.max.area = (int)strtol(optarg, NULL, 0); break;
+			default:
+				Print_Usage();
+				return 1;
+		}
+	}
+
+	options.num_rooms = CLAMP(options.num_rooms, MIN_ROOMS, MAX_ROOMS);
+	options.num_threads = CLAMP(options.num_threads, 1, 1024);
+	if (world_w < MIN_ROOM_SIZE || world_h < MIN_ROOM_SIZE) {
+		fprintf(stderr, "The world must be at least %dx%d.\n", MIN_ROOM_SIZE, MIN_ROOM_SIZE);
+		return 1;
+	}
+
+	prefab_library_t prefab_library;
+	if (prefab_directory != NULL) {
+		if (!Init_PrefabLibrary(&prefab_library, prefab_directory)) {
+			fprintf(stderr, "The prefab directory \"%s\" could not be opened.\n", prefab_directory);
+			return 1;
+		}
+		options.prefab_library = &prefab_library;
+	}
+
+	// Floors are generated off-screen; the screen buffer only sets the world's dimensions.
+	GEO_override_screen_size(world_w + RIGHT_PANEL_OFFSET, world_h + BOTTOM_PANEL_OFFSET);
+
+	search_shared_t shared = {.options = &options, .next_offset = 0, .num_matches = 0};
+	pthread_mutex_init(&shared.output_lock, NULL);
+
+	pthread_t *threads = malloc(sizeof(*threads) * options.num_threads);
+	if (threads == NULL) {
+		if (options.prefab_library != NULL) {
+			Cleanup_PrefabLibrary(&prefab_library);
+		}
+		return 1;
+	}
+	// Seeds are handed out from a shared counter, so the threads that did start still search every seed.
+	int num_started = 0;
+	while (num_started < options.num_threads && pthread_create(&threads[num_started], NULL, Search_Seeds, &shared) == 0) {
+		num_started++;
+	}
+	for (int i = 0; i < num_started; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	free(threads);
+
+	pthread_mutex_destroy(&shared.output_lock);
+	if (options.prefab_library != NULL) {
+		Cleanup_PrefabLibrary(&prefab_library);
+	}
+	if (num_started == 0) {
+		fprintf(stderr, "No search threads could be started.\n");
+		return 1;
+	}
+	fprintf(stderr, "%llu of %llu seeds matched.\n", shared.num_matches, options.num_seeds);
+
+	return 0;
+}